@@ -0,0 +1,164 @@
+#include <cassert>
+#include <algorithm>
+#include "achievement_engine.h"
+
+namespace Mif {
+
+    AchievementEngine::AchievementEngine(uint32_t numEventTypes)
+    : m_numEventTypes(numEventTypes)
+    , m_numPlayers(0)
+    , m_wordsPerPlayer(0)
+    , m_compiled(false)
+    {
+        ;
+    }
+
+
+    AchievementId AchievementEngine::defineAchievement(uint32_t event, uint32_t threshold)
+    {
+        assert(!m_compiled && "achievements must be defined before compile()");
+        assert(event < m_numEventTypes && "unknown event type");
+        assert(threshold > 0 && "threshold must be positive");
+
+        const AchievementId id = numAchievements();
+        m_definitions.push_back(Rule{ threshold, id });
+        m_definitionEvents.push_back(event);
+
+        return id;
+    }
+
+
+    void AchievementEngine::compile()
+    {
+        assert(!m_compiled && "compile() is called once");
+        assert(m_numPlayers == 0 && "players are added after compile()");
+
+        m_ruleStart.assign(m_numEventTypes + 1, 0);
+
+        for (uint32_t event : m_definitionEvents)
+        {
+            m_ruleStart[event + 1]++;
+        }
+
+        for (uint32_t e = 0; e < m_numEventTypes; e++)
+        {
+            m_ruleStart[e + 1] += m_ruleStart[e];
+        }
+
+        m_rules.resize(m_definitions.size());
+        std::vector<uint32_t> cursor(m_ruleStart.begin(), m_ruleStart.end() - 1);
+
+        for (size_t i = 0; i < m_definitions.size(); i++)
+        {
+            m_rules[cursor[m_definitionEvents[i]]++] = m_definitions[i];
+        }
+
+        for (uint32_t e = 0; e < m_numEventTypes; e++)
+        {
+            std::sort(m_rules.begin() + m_ruleStart[e], m_rules.begin() + m_ruleStart[e + 1],
+                [](const Rule& a, const Rule& b) { return a.threshold < b.threshold; });
+        }
+
+        m_wordsPerPlayer = (numAchievements() + 63) / 64;
+        m_compiled = true;
+    }
+
+
+    void AchievementEngine::addPlayers(uint32_t count)
+    {
+        assert(m_compiled && "compile() must be called before adding players");
+
+        m_numPlayers += count;
+        m_counters.resize(static_cast<size_t>(m_numPlayers) * m_numEventTypes, 0);
+        m_unlocked.resize(static_cast<size_t>(m_numPlayers) * m_wordsPerPlayer, 0);
+    }
+
+
+    uint32_t AchievementEngine::record(const PlayerEvent& event, std::vector<Unlock>* unlocks)
+    {
+        assert(event.player < m_numPlayers && "unknown player");
+        assert(event.event < m_numEventTypes && "unknown event type");
+
+        uint32_t& counter = m_counters[static_cast<size_t>(event.player) * m_numEventTypes + event.event];
+        const uint32_t before = counter;
+        const uint32_t after = (before > UINT32_MAX - event.amount) ? UINT32_MAX : before + event.amount;
+        counter = after;
+
+        const Rule* const begin = m_rules.data() + m_ruleStart[event.event];
+        const Rule* const end = m_rules.data() + m_ruleStart[event.event + 1];
+
+        // thresholds in (before, after] are the ones crossed now
+        const Rule* it = std::upper_bound(begin, end, before,
+            [](uint32_t value, const Rule& rule) { return value < rule.threshold; });
+
+        uint32_t numUnlocks = 0;
+        uint64_t* const bits = m_unlocked.data() + static_cast<size_t>(event.player) * m_wordsPerPlayer;
+
+        for (; it != end && it->threshold <= after; ++it)
+        {
+            bits[it->achievement >> 6] |= 1ull << (it->achievement & 63);
+            numUnlocks++;
+
+            if (unlocks)
+                unlocks->push_back(Unlock{ event.player, it->achievement });
+        }
+
+        return numUnlocks;
+    }
+
+
+    uint32_t AchievementEngine::evaluate(const PlayerEvent* events, uint32_t count, std::vector<Unlock>* unlocks)
+    {
+        // counting sort by event type; keeps the per-player order inside a type
+        std::vector<uint32_t> offsets(m_numEventTypes + 1, 0);
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            assert(events[i].event < m_numEventTypes && "unknown event type");
+            offsets[events[i].event + 1]++;
+        }
+
+        for (uint32_t e = 0; e < m_numEventTypes; e++)
+        {
+            offsets[e + 1] += offsets[e];
+        }
+
+        m_sorted.resize(count);
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            m_sorted[offsets[events[i].event]++] = events[i];
+        }
+
+        uint32_t numUnlocks = 0;
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            numUnlocks += record(m_sorted[i], unlocks);
+        }
+
+        return numUnlocks;
+    }
+
+
+    bool AchievementEngine::isUnlocked(PlayerId player, AchievementId achievement) const
+    {
+        const uint64_t word = m_unlocked[static_cast<size_t>(player) * m_wordsPerPlayer + (achievement >> 6)];
+        return (word >> (achievement & 63)) & 1;
+    }
+
+
+    uint32_t AchievementEngine::numUnlocked(PlayerId player) const
+    {
+        const uint64_t* const bits = m_unlocked.data() + static_cast<size_t>(player) * m_wordsPerPlayer;
+        uint32_t n = 0;
+
+        for (uint32_t w = 0; w < m_wordsPerPlayer; w++)
+        {
+            n += __builtin_popcountll(bits[w]);
+        }
+
+        return n;
+    }
+
+} // namespace Mif
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Mif {
+
+    typedef uint32_t PlayerId;
+    typedef uint32_t AchievementId;
+
+    struct PlayerEvent {
+        PlayerId player;
+        uint32_t event;   // event type, < numEventTypes
+        uint32_t amount;  // how many times it happened
+    };
+
+    struct Unlock {
+        PlayerId player;
+        AchievementId achievement;
+    };
+
+    // Table-driven achievement evaluation for many players.
+    //
+    // An achievement unlocks once a player's count of one event type reaches
+    // a threshold. compile() turns the definitions into one threshold-sorted
+    // rule run per event type, so an event only looks at the rules of its own
+    // type, and only at thresholds crossed by this increment.
+    //
+    // Per player the engine stores one 32-bit counter per event type and one
+    // bit per achievement, each in a single array strided by player.
+    class AchievementEngine {
+    public:
+        explicit AchievementEngine(uint32_t numEventTypes);
+
+        AchievementId defineAchievement(uint32_t event, uint32_t threshold);
+        void compile();
+
+        void addPlayers(uint32_t count);
+
+        // applies one event; unlocks are appended to unlocks if not null
+        uint32_t record(const PlayerEvent& event, std::vector<Unlock>* unlocks = nullptr);
+
+        // applies a whole tick of events grouped by event type, so that the
+        // rule run of a type stays hot while its events are applied
+        uint32_t evaluate(const PlayerEvent* events, uint32_t count, std::vector<Unlock>* unlocks = nullptr);
+
+        bool isUnlocked(PlayerId player, AchievementId achievement) const;
+        uint32_t numUnlocked(PlayerId player) const;
+        uint32_t counter(PlayerId player, uint32_t event) const { return m_counters[player * m_numEventTypes + event]; }
+
+        uint32_t numPlayers() const { return m_numPlayers; }
+        uint32_t numAchievements() const { return static_cast<uint32_t>(m_definitions.size()); }
+        size_t bytesPerPlayer() const { return m_numEventTypes * sizeof(uint32_t) + m_wordsPerPlayer * sizeof(uint64_t); }
+
+    private:
+        struct Rule {
+            uint32_t threshold;
+            AchievementId achievement;
+        };
+
+        const uint32_t m_numEventTypes;
+        uint32_t m_numPlayers;
+        uint32_t m_wordsPerPlayer;
+        bool m_compiled;
+
+        std::vector<Rule> m_definitions;   // indexed by achievement, threshold + event
+        std::vector<uint32_t> m_definitionEvents;
+
+        std::vector<uint32_t> m_ruleStart; // numEventTypes + 1 offsets into m_rules
+        std::vector<Rule> m_rules;         // per event type, ascending thresholds
+
+        std::vector<uint32_t> m_counters;  // player * numEventTypes + event
+        std::vector<uint64_t> m_unlocked;  // player * wordsPerPlayer + word
+
+        std::vector<PlayerEvent> m_sorted; // scratch for evaluate()
+    };
+
+} // namespace Mif
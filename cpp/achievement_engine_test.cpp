@@ -0,0 +1,117 @@
+#include <cstdio>
+#include <vector>
+#include "achievement_engine.h"
+#include "gtest/gtest.h"
+
+namespace { // for constants
+    const uint32_t kNumEventTypes = 3;
+    const uint32_t kNumPlayers = 1000;
+} // namespace anonymouse
+
+
+namespace { // for functions
+
+    TEST(AchievementEngineTest, thresholds)
+    {
+        Mif::AchievementEngine engine(kNumEventTypes);
+
+        const Mif::AchievementId fall10 = engine.defineAchievement(0, 10);
+        const Mif::AchievementId jump1 = engine.defineAchievement(1, 1);
+        const Mif::AchievementId fall1 = engine.defineAchievement(0, 1);
+        const Mif::AchievementId fall3 = engine.defineAchievement(0, 3);
+        engine.compile();
+        engine.addPlayers(2);
+
+        std::vector<Mif::Unlock> unlocks;
+
+        EXPECT_EQ(engine.record(Mif::PlayerEvent{ 1, 0, 1 }, &unlocks), 1);
+        EXPECT_TRUE(engine.isUnlocked(1, fall1));
+        EXPECT_FALSE(engine.isUnlocked(0, fall1));
+
+        // one increment crossing two thresholds unlocks both, in threshold order
+        unlocks.clear();
+        EXPECT_EQ(engine.record(Mif::PlayerEvent{ 1, 0, 9 }, &unlocks), 2);
+        ASSERT_EQ(unlocks.size(), 2);
+        EXPECT_EQ(unlocks[0].achievement, fall3);
+        EXPECT_EQ(unlocks[1].achievement, fall10);
+
+        // already crossed thresholds do not unlock again
+        EXPECT_EQ(engine.record(Mif::PlayerEvent{ 1, 0, 5 }), 0);
+        EXPECT_EQ(engine.counter(1, 0), 15);
+
+        EXPECT_FALSE(engine.isUnlocked(1, jump1));
+        EXPECT_EQ(engine.numUnlocked(1), 3);
+        EXPECT_EQ(engine.numUnlocked(0), 0);
+    }
+
+
+    TEST(AchievementEngineTest, evaluateBatch)
+    {
+        const uint32_t kNumAchievements = 130;  // three words per player
+
+        Mif::AchievementEngine engine(kNumEventTypes);
+
+        for (uint32_t i = 0; i < kNumAchievements; i++)
+        {
+            engine.defineAchievement(i % kNumEventTypes, i / kNumEventTypes + 1);
+        }
+
+        engine.compile();
+        engine.addPlayers(kNumPlayers);
+
+        EXPECT_EQ(engine.bytesPerPlayer(), kNumEventTypes * sizeof(uint32_t) + 3 * sizeof(uint64_t));
+
+        std::vector<Mif::PlayerEvent> events;
+
+        for (uint32_t p = 0; p < kNumPlayers; p++)
+        {
+            // player p sees event type p % 3, p % 50 times, in single steps
+            for (uint32_t n = 0; n < p % 50; n++)
+            {
+                events.push_back(Mif::PlayerEvent{ p, p % kNumEventTypes, 1 });
+            }
+        }
+
+        std::vector<Mif::Unlock> unlocks;
+        const uint32_t numUnlocks = engine.evaluate(events.data(), static_cast<uint32_t>(events.size()), &unlocks);
+        EXPECT_EQ(numUnlocks, unlocks.size());
+
+        uint32_t expected = 0;
+
+        for (uint32_t p = 0; p < kNumPlayers; p++)
+        {
+            const uint32_t type = p % kNumEventTypes;
+            const uint32_t count = p % 50;
+            uint32_t perPlayer = 0;
+
+            for (uint32_t i = type; i < kNumAchievements; i += kNumEventTypes)
+            {
+                const bool unlocked = i / kNumEventTypes + 1 <= count;
+                EXPECT_EQ(engine.isUnlocked(p, i), unlocked) << p << " " << i;
+                perPlayer += unlocked;
+            }
+
+            EXPECT_EQ(engine.numUnlocked(p), perPlayer);
+            expected += perPlayer;
+        }
+
+        EXPECT_EQ(numUnlocks, expected);
+    }
+
+
+    TEST(AchievementEngineTest, addPlayersKeepsState)
+    {
+        Mif::AchievementEngine engine(kNumEventTypes);
+        const Mif::AchievementId a = engine.defineAchievement(2, 2);
+        engine.compile();
+
+        engine.addPlayers(1);
+        engine.record(Mif::PlayerEvent{ 0, 2, 2 });
+        engine.addPlayers(kNumPlayers);
+
+        EXPECT_EQ(engine.numPlayers(), kNumPlayers + 1);
+        EXPECT_TRUE(engine.isUnlocked(0, a));
+        EXPECT_FALSE(engine.isUnlocked(kNumPlayers, a));
+    }
+
+} // namespace anonymouse
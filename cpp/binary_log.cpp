@@ -0,0 +1,204 @@
+#include <cassert>
+#include <cstdlib>
+#include <chrono>
+#include "binary_log.h"
+
+namespace Mif {
+
+    namespace {
+        const auto kIdleSleep = std::chrono::milliseconds(1);
+
+        // trivially destructible, so it can still be read while the other
+        // thread_local objects of an exiting thread are being destroyed
+        thread_local LogBuffer* t_buffer = nullptr;
+        thread_local bool t_exiting = false;
+
+        // gives the buffer back when its thread exits
+        struct BufferRelease {
+            ~BufferRelease()
+            {
+                if (t_buffer)
+                    t_buffer->release();
+
+                t_buffer = nullptr;
+                t_exiting = true;
+            }
+        };
+
+        thread_local BufferRelease t_release;
+    } // namespace anonymouse
+
+
+    LogBuffer::LogBuffer()
+    : m_head(0)
+    , m_reserved(0)
+    , m_dropped(0)
+    , m_tail(0)
+    , m_inUse(false)
+    {
+        static_assert((kCapacity & (kCapacity - 1)) == 0, "capacity must be a power of two");
+    }
+
+
+    uint8_t* LogBuffer::reserve(uint32_t size, const LogSite* site, LogFormatFunc format)
+    {
+        assert(size % 8 == 0 && size <= kCapacity / 2 && "log record too large");
+
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        const uint64_t tail = m_tail.load(std::memory_order_acquire);
+
+        // records never wrap; skip the rest of the ring if this one does not fit
+        const uint32_t remaining = kCapacity - static_cast<uint32_t>(head & (kCapacity - 1));
+        const uint32_t skip = remaining < size ? remaining : 0;
+
+        if (head + skip + size - tail > kCapacity)
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        if (skip >= sizeof(LogRecordHeader))
+        {
+            const LogRecordHeader padding = { nullptr, nullptr, skip, 0 };
+            std::memcpy(m_data + (head & (kCapacity - 1)), &padding, sizeof(padding));
+        }
+
+        head += skip;
+
+        uint8_t* const record = m_data + (head & (kCapacity - 1));
+        const LogRecordHeader header = { site, format, size, 0 };
+        std::memcpy(record, &header, sizeof(header));
+
+        m_reserved = head + size;
+        return record + sizeof(header);
+    }
+
+
+    Logger& Logger::instance()
+    {
+        // leaked on purpose: see shutdown()
+        static Logger* const logger = new Logger();
+        return *logger;
+    }
+
+
+    Logger::Logger()
+    : m_output(nullptr)
+    , m_stop(false)
+    , m_synchronous(false)
+    {
+        m_thread = std::thread(&Logger::run, this);
+        std::atexit(&Logger::shutdown);
+    }
+
+
+    LogBuffer* Logger::threadBuffer()
+    {
+        if (t_buffer || t_exiting)
+            return t_buffer;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        for (LogBuffer* buffer : m_buffers)
+        {
+            if (buffer->acquire())
+            {
+                t_buffer = buffer;
+                break;
+            }
+        }
+
+        if (t_buffer == nullptr)
+        {
+            t_buffer = new LogBuffer();
+            t_buffer->acquire();
+            m_buffers.push_back(t_buffer);
+        }
+
+        (void)t_release;  // odr-use, so the release hook is constructed
+        return t_buffer;
+    }
+
+
+    uint32_t Logger::flush()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        uint32_t count = 0;
+
+        for (LogBuffer* buffer : m_buffers)
+        {
+            count += buffer->drain([this](const LogSite* site, const char* text) {
+                emit(site, text);
+            });
+        }
+
+        if (m_output)
+            fflush(m_output);
+        else
+            fflush(stdout);
+
+        return count;
+    }
+
+
+    void Logger::setOutput(FILE* out)
+    {
+        flush();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_output = out;
+    }
+
+
+    uint64_t Logger::dropped() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        uint64_t n = 0;
+
+        for (const LogBuffer* buffer : m_buffers)
+        {
+            n += buffer->dropped();
+        }
+
+        return n;
+    }
+
+
+    size_t Logger::numBuffers() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_buffers.size();
+    }
+
+
+    void Logger::emit(const LogSite* site, const char* text)
+    {
+        FILE* const out = m_output ? m_output : (site->level >= LogLevel::WARN ? stderr : stdout);
+        fprintf(out, "L%d %s(): %s", site->line, site->func, text);
+    }
+
+
+    void Logger::run()
+    {
+        while (!m_stop.load(std::memory_order_acquire))
+        {
+            if (flush() == 0)
+                std::this_thread::sleep_for(kIdleSleep);
+        }
+    }
+
+
+    void Logger::shutdown()
+    {
+        Logger& logger = instance();
+
+        logger.m_stop.store(true, std::memory_order_release);
+
+        if (logger.m_thread.joinable())
+            logger.m_thread.join();
+
+        logger.m_synchronous.store(true, std::memory_order_release);
+        logger.flush();
+    }
+
+} // namespace Mif
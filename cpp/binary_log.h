@@ -0,0 +1,302 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+// Binary logging.
+//
+// MIF_LOG(level, fmt, args...) does not format on the calling thread. It
+// copies the address of a static LogSite (the format id) and the raw
+// argument bytes into a per-thread SPSC ring; a background thread formats
+// them with printf semantics. Records from one thread keep their order.
+//
+// Levels below MIF_LOG_LEVEL are removed at compile time.
+
+#ifndef MIF_LOG_LEVEL
+#define MIF_LOG_LEVEL 1 // DEBUG
+#endif
+
+#define MIF_LOG(level, fmt, ...) \
+    do { \
+        if constexpr (Mif::logEnabled(Mif::LogLevel::level)) { \
+            static const Mif::LogSite mifLogSite = { Mif::LogLevel::level, __LINE__, __func__, fmt }; \
+            if (false) \
+                printf(fmt __VA_OPT__(,) __VA_ARGS__); /* format checking only */ \
+            Mif::logWrite(&mifLogSite __VA_OPT__(,) __VA_ARGS__); \
+        } \
+    } while (false)
+
+// perror() replacement: "msg: strerror(errno)"
+#define MIF_LOG_ERRNO(level, msg) \
+    do { \
+        if constexpr (Mif::logEnabled(Mif::LogLevel::level)) { \
+            static const Mif::LogSite mifLogSite = { Mif::LogLevel::level, __LINE__, __func__, "%s: %s\n" }; \
+            Mif::logWrite(&mifLogSite, static_cast<const char*>(msg), Mif::LogErrno{ errno }); \
+        } \
+    } while (false)
+
+namespace Mif {
+
+    enum class LogLevel : uint8_t {
+        TRACE = 0,
+        DEBUG,
+        INFO,
+        WARN,
+        ERROR,
+    };
+
+    // MIF_LOG_LEVEL as a typed constant: comparing a LogLevel with the
+    // literal 0 would warn (always true) at every call site
+    constexpr int kLogLevel = MIF_LOG_LEVEL;
+
+    constexpr bool logEnabled(LogLevel level)
+    {
+        return static_cast<int>(level) >= kLogLevel;
+    }
+
+
+    // everything known at compile time about one MIF_LOG() call
+    struct LogSite {
+        LogLevel level;
+        int line;
+        const char* func;
+        const char* format;
+    };
+
+    // errno captured as an int; formatted with strerror() as a %s
+    struct LogErrno {
+        int value;
+    };
+
+
+    // Argument encoding. Scalars are copied as is; strings are copied with
+    // their terminator, since the pointer may be dead by the time the
+    // background thread formats the record.
+    template<typename T>
+    struct LogArg {
+        static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value,
+                "only scalars, pointers and strings can be logged");
+
+        static size_t size(T) { return sizeof(T); }
+        static void write(uint8_t*& p, T value) { std::memcpy(p, &value, sizeof(T)); p += sizeof(T); }
+        static T read(const uint8_t*& p) { T value; std::memcpy(&value, p, sizeof(T)); p += sizeof(T); return value; }
+    };
+
+    template<>
+    struct LogArg<const char*> {
+        static size_t size(const char* s) { return sizeof(uint32_t) + std::strlen(s) + 1; }
+
+        static void write(uint8_t*& p, const char* s)
+        {
+            const uint32_t length = static_cast<uint32_t>(std::strlen(s)) + 1;
+            std::memcpy(p, &length, sizeof(length));
+            std::memcpy(p + sizeof(length), s, length);
+            p += sizeof(length) + length;
+        }
+
+        static const char* read(const uint8_t*& p)
+        {
+            uint32_t length;
+            std::memcpy(&length, p, sizeof(length));
+            const char* s = reinterpret_cast<const char*>(p + sizeof(length));
+            p += sizeof(length) + length;
+            return s;
+        }
+    };
+
+    template<>
+    struct LogArg<char*> : LogArg<const char*> {};
+
+    template<>
+    struct LogArg<LogErrno> {
+        static size_t size(LogErrno) { return sizeof(int); }
+        static void write(uint8_t*& p, LogErrno e) { LogArg<int>::write(p, e.value); }
+        static const char* read(const uint8_t*& p) { return std::strerror(LogArg<int>::read(p)); }
+    };
+
+
+    typedef void (*LogFormatFunc)(const LogSite* site, const uint8_t* payload, char* out, size_t size);
+
+    template<typename... Args>
+    void formatLogRecord(const LogSite* site, const uint8_t* payload, char* out, size_t size)
+    {
+        const uint8_t* p = payload;
+
+        // braced initialization reads the arguments left to right
+        const std::tuple<decltype(LogArg<Args>::read(p))...> values{ LogArg<Args>::read(p)... };
+
+        std::apply([site, out, size](auto... args) {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#pragma GCC diagnostic ignored "-Wformat-security"
+            snprintf(out, size, site->format, args...);
+#pragma GCC diagnostic pop
+        }, values);
+        (void)p;
+    }
+
+
+    struct LogRecordHeader {
+        const LogSite* site;    // nullptr marks padding up to the end of the ring
+        LogFormatFunc format;
+        uint32_t size;          // total record size, header included, multiple of 8
+        uint32_t reserved;
+    };
+
+
+    // Single producer (the owning thread), single consumer (the formatter).
+    class LogBuffer {
+    public:
+        static const uint32_t kCapacity = 64 * 1024;
+
+        LogBuffer();
+
+        // returns the payload of a size byte record, or nullptr if the ring
+        // is full; the record is published by commit()
+        uint8_t* reserve(uint32_t size, const LogSite* site, LogFormatFunc format);
+        void commit() { m_head.store(m_reserved, std::memory_order_release); }
+
+        // formats and hands every committed record to emit(site, text)
+        template<typename Emit>
+        uint32_t drain(Emit&& emit);
+
+        uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+        // a buffer is owned by one thread at a time and reused after it exits
+        bool acquire() { return !m_inUse.exchange(true, std::memory_order_acquire); }
+        void release() { m_inUse.store(false, std::memory_order_release); }
+
+    private:
+        alignas(64) std::atomic<uint64_t> m_head;
+        uint64_t m_reserved;
+        std::atomic<uint64_t> m_dropped;
+        alignas(64) std::atomic<uint64_t> m_tail;
+        alignas(64) std::atomic<bool> m_inUse;
+        uint8_t m_data[kCapacity];
+    };
+
+
+    template<typename Emit>
+    uint32_t LogBuffer::drain(Emit&& emit)
+    {
+        uint64_t tail = m_tail.load(std::memory_order_relaxed);
+        const uint64_t head = m_head.load(std::memory_order_acquire);
+        uint32_t count = 0;
+        char text[1024];
+
+        while (tail < head)
+        {
+            const uint32_t offset = static_cast<uint32_t>(tail & (kCapacity - 1));
+            const uint32_t remaining = kCapacity - offset;
+
+            if (remaining < sizeof(LogRecordHeader))
+            {
+                tail += remaining;
+                continue;
+            }
+
+            LogRecordHeader header;
+            std::memcpy(&header, m_data + offset, sizeof(header));
+
+            if (header.site == nullptr)
+            {
+                tail += remaining;
+                continue;
+            }
+
+            header.format(header.site, m_data + offset + sizeof(header), text, sizeof(text));
+            emit(header.site, text);
+
+            tail += header.size;
+            count++;
+        }
+
+        m_tail.store(tail, std::memory_order_release);
+        return count;
+    }
+
+
+    // Owns the per-thread buffers and the formatter thread. Never destroyed;
+    // at exit the buffers are drained and later records are formatted
+    // synchronously, so logging from static destructors still works.
+    class Logger {
+    public:
+        static Logger& instance();
+
+        // buffer of the calling thread, or nullptr once the thread is exiting
+        LogBuffer* threadBuffer();
+
+        // formats everything pending; returns the number of records
+        uint32_t flush();
+
+        // sends all levels to out; nullptr restores stdout, and stderr for
+        // WARN and above
+        void setOutput(FILE* out);
+
+        bool synchronous() const { return m_synchronous.load(std::memory_order_acquire); }
+        uint64_t dropped() const;
+        size_t numBuffers() const;
+
+        void emit(const LogSite* site, const char* text);
+
+    private:
+        Logger();
+
+        void run();
+        static void shutdown();
+
+        mutable std::mutex m_mutex;     // buffers list, consumer side, output
+        std::vector<LogBuffer*> m_buffers;
+        FILE* m_output;
+        std::atomic<bool> m_stop;
+        std::atomic<bool> m_synchronous;
+        std::thread m_thread;
+    };
+
+
+    template<typename... Args>
+    void logWrite(const LogSite* site, Args... args)
+    {
+        const uint32_t payload = static_cast<uint32_t>((sizeof(LogRecordHeader) + ... + LogArg<Args>::size(args)));
+        const uint32_t size = (payload + 7) & ~7u;
+
+        Logger& logger = Logger::instance();
+        LogBuffer* const buffer = logger.threadBuffer();
+
+        if (buffer == nullptr || logger.synchronous())
+        {
+            // exiting: format right here, after what the buffers still hold
+            logger.flush();
+
+            std::vector<uint8_t> bytes(size);
+            uint8_t* p = bytes.data();
+            (LogArg<Args>::write(p, args), ...);
+            (void)p;
+
+            char text[1024];
+            formatLogRecord<Args...>(site, bytes.data(), text, sizeof(text));
+            logger.emit(site, text);
+            return;
+        }
+
+        uint8_t* p = buffer->reserve(size, site, &formatLogRecord<Args...>);
+
+        if (p == nullptr)
+            return;
+
+        (LogArg<Args>::write(p, args), ...);
+        (void)p;
+        buffer->commit();
+    }
+
+    inline void logFlush() { Logger::instance().flush(); }
+
+} // namespace Mif
@@ -0,0 +1,131 @@
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "binary_log.h"
+#include "gtest/gtest.h"
+
+namespace { // for constants
+    const uint32_t kNumThreads = 4;
+    const uint32_t kRecordsPerThread = 500;
+} // namespace anonymouse
+
+namespace { // for test fixture
+    class BinaryLogTest : public ::testing::Test
+    {
+    public:
+        void SetUp();
+        void TearDown();
+
+        // flushes the logger and returns what it wrote since SetUp()
+        std::vector<std::string> lines();
+
+        FILE* out_;
+    };
+
+    void BinaryLogTest::SetUp()
+    {
+        out_ = tmpfile();
+        ASSERT_NE(out_, nullptr);
+        Mif::Logger::instance().setOutput(out_);
+    }
+
+    void BinaryLogTest::TearDown()
+    {
+        Mif::Logger::instance().setOutput(nullptr);
+        fclose(out_);
+    }
+
+    std::vector<std::string> BinaryLogTest::lines()
+    {
+        Mif::logFlush();
+        rewind(out_);
+
+        std::vector<std::string> result;
+        char line[1024];
+
+        while (fgets(line, sizeof(line), out_))
+        {
+            result.push_back(line);
+        }
+
+        return result;
+    }
+} // namespace anonymouse
+
+
+namespace { // for functions
+
+    TEST_F(BinaryLogTest, formatsRawArguments)
+    {
+        char name[16];
+        strcpy(name, "hero");
+
+        MIF_LOG(INFO, "%s has %d lives and %.2f hp\n", name, 3, 12.5f);
+        strcpy(name, "zero");  // the record holds its own copy
+
+        errno = ENOENT;
+        MIF_LOG_ERRNO(ERROR, "open");
+
+        MIF_LOG(TRACE, "compiled out\n");
+
+        const std::vector<std::string> result = lines();
+        ASSERT_EQ(result.size(), 2);
+
+        // "L<line> TestBody(): ..."
+        EXPECT_NE(result[0].find(" TestBody(): hero has 3 lives and 12.50 hp\n"), std::string::npos) << result[0];
+        EXPECT_NE(result[1].find("open: " + std::string(strerror(ENOENT))), std::string::npos) << result[1];
+    }
+
+
+    TEST_F(BinaryLogTest, perThreadOrder)
+    {
+        std::vector<std::thread> threads;
+
+        for (uint32_t t = 0; t < kNumThreads; t++)
+        {
+            threads.emplace_back([t]() {
+                for (uint32_t i = 0; i < kRecordsPerThread; i++)
+                {
+                    MIF_LOG(DEBUG, "thread %u record %u\n", t, i);
+                }
+            });
+        }
+
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        const std::vector<std::string> result = lines();
+        std::vector<uint32_t> next(kNumThreads, 0);
+
+        for (const std::string& line : result)
+        {
+            uint32_t t, i;
+            ASSERT_EQ(sscanf(line.c_str() + line.find("(): ") + 4, "thread %u record %u", &t, &i), 2) << line;
+            ASSERT_LT(t, kNumThreads);
+            EXPECT_EQ(i, next[t]++);
+        }
+
+        EXPECT_EQ(result.size() + Mif::Logger::instance().dropped(), kNumThreads * kRecordsPerThread);
+    }
+
+
+    TEST_F(BinaryLogTest, buffersAreReused)
+    {
+        std::thread([]() { MIF_LOG(INFO, "warm up\n"); }).join();
+        const size_t numBuffers = Mif::Logger::instance().numBuffers();
+
+        for (int i = 0; i < 8; i++)
+        {
+            std::thread([i]() { MIF_LOG(INFO, "short lived %d\n", i); }).join();
+        }
+
+        EXPECT_EQ(Mif::Logger::instance().numBuffers(), numBuffers);
+        EXPECT_EQ(lines().size(), 9);
+    }
+
+} // namespace anonymouse
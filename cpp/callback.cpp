@@ -1,7 +1,13 @@
 #include <cstdio>
+#include <cstring>
+#include "callback_chain.h"
+#include "callback_registry.h"
+#include "delegate.h"
+#include "executor.h"
 using namespace std;
 
 typedef void (* FUNC_POINTER)(const char *);
+typedef Mif::Delegate<void(const char *)> FUNC_DELEGATE;
 
 void callback1(const char *s)
 {
@@ -15,12 +21,50 @@ void callback2(const char *s)
 }
 
 
+void callbackBatch(const char * const *inputs, uint32_t count)
+{
+    printf("%s: %u inputs, first [%s]\n", __func__, count, inputs[0]);
+}
+
+
+// drops the "key=" part; the result still points into the caller's buffer
+string_view value(void *, string_view s, Mif::StackAllocator &)
+{
+    const size_t eq = s.find('=');
+    return eq == string_view::npos ? s : s.substr(eq + 1);
+}
+
+
+// writes a new payload, so it takes the bytes from the arena
+string_view quote(void *, string_view s, Mif::StackAllocator &arena)
+{
+    char *out = static_cast<char *>(arena.alloc(s.size() + 2, 1));
+    out[0] = '"';
+    memcpy(out + 1, s.data(), s.size());
+    out[s.size() + 1] = '"';
+    return string_view(out, s.size() + 2);
+}
+
+
+void printView(void *context, string_view s)
+{
+    printf("%s: %s %.*s\n", __func__, static_cast<const char *>(context), static_cast<int>(s.size()), s.data());
+}
+
+
 void func(const char *s, FUNC_POINTER p)
 {
     p(s);
 }
 
 
+// same as above, but the callback may carry state
+void func(const char *s, const FUNC_DELEGATE& d)
+{
+    d(s);
+}
+
+
 int main()
 {
     FUNC_POINTER p;
@@ -31,5 +75,42 @@ int main()
     p = callback2;
     func("call callback2()", p);
 
+    int count = 0;
+    func("call lambda", [&count](const char *s) {
+        printf("%s: (%d) %s\n", __func__, ++count, s);
+    });
+
+    // many callbacks per topic, each run over the whole batch of inputs
+    enum Topic : Mif::TopicId { TOPIC_LOAD, NUM_TOPICS };
+
+    Mif::CallbackRegistry registry(NUM_TOPICS);
+    registry.add(TOPIC_LOAD, callback1);
+    registry.add(TOPIC_LOAD, callback2);
+    registry.add(TOPIC_LOAD, callbackBatch);
+
+    const char * const inputs[] = { "plugin a", "plugin b", "plugin c" };
+    registry.invoke(TOPIC_LOAD, inputs, sizeof(inputs) / sizeof(inputs[0]));
+
+    // length-carrying views through a chain; only quote() writes new bytes
+    char memory[256];
+    Mif::StackAllocator arena(memory, sizeof(memory));
+
+    Mif::TextChain chain(arena);
+    chain.add(value);
+    chain.add(Mif::TextCallback{ printView, const_cast<char *>("value") });
+    chain.add(quote);
+
+    const char line[] = "name=observer;ignored";
+    const string_view quoted = chain.run(string_view(line, strchr(line, ';') - line));
+    printView(const_cast<char *>("quoted"), quoted);
+    arena.reset();
+
+    // the same callbacks, run later on pinned workers; one key, one worker
+    Mif::Executor executor(2);
+    Mif::WaitGroup group;
+    executor.post(1, callback1, "posted first", &group);
+    executor.post(1, callback2, "posted second", &group);
+    executor.wait(group);
+
     return 0;
 }
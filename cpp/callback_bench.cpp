@@ -0,0 +1,249 @@
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <functional>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "delegate.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+using namespace std;
+
+// Cost of invoking a callback through each dispatch mechanism of this repo,
+// at call sites that see 1 (monomorphic), 4 (polymorphic) or 64
+// (megamorphic) different targets in a random order:
+//
+//   FUNC_POINTER    a free function per target, as in callback.cpp
+//   virtual         an Observer-style onNotify(), one derived class per target
+//   std::function   a lambda per target
+//   template        a functor type per target, statically dispatched;
+//                   1 type is a direct inlined call, more use std::visit
+//   Delegate        Mif::Delegate bound to a lambda per target
+//
+// Reports ns per call and, on Linux when perf events are available,
+// branch misses per call.
+
+#define VPRINTF(...) \
+    do { \
+        printf(__VA_ARGS__); \
+    } while (false)
+
+namespace {
+
+    const uint32_t kMaxTargets = 64;
+    const uint32_t kSiteSize = 64 * 1024;        // precomputed target sequence
+    const uint32_t kRepeat = 200;
+    const uint32_t kTargetCounts[] = { 1, 4, kMaxTargets };
+
+    typedef void (*FUNC_POINTER)(const char *);
+
+    uint64_t g_sink = 0;
+
+    template <uint32_t K>
+    __attribute__((noinline)) void callback(const char *s)
+    {
+        g_sink += K + static_cast<uint8_t>(s[0]);
+    }
+
+    // the shape of Observer::onNotify() in observer.cpp, which is a program
+    class Observer {
+    public:
+        virtual ~Observer() {}
+        virtual void onNotify(const char *s) = 0;
+    };
+
+    template <uint32_t K>
+    class Target : public Observer {
+    public:
+        __attribute__((noinline)) void onNotify(const char *s) override { callback<K>(s); }
+    };
+
+    template <uint32_t K>
+    struct Functor {
+        void operator()(const char *s) const { g_sink += K + static_cast<uint8_t>(s[0]); }
+    };
+
+    template <size_t... K>
+    variant<Functor<K>...> makeFunctorVariant(index_sequence<K...>);
+
+    typedef decltype(makeFunctorVariant(make_index_sequence<kMaxTargets>())) AnyFunctor;
+
+
+    // one instance of every mechanism for each of the kMaxTargets targets
+    struct Targets {
+        FUNC_POINTER pointers[kMaxTargets];
+        Observer *observers[kMaxTargets];
+        function<void(const char *)> functions[kMaxTargets];
+        AnyFunctor functors[kMaxTargets];
+        Mif::Delegate<void(const char *)> delegates[kMaxTargets];
+
+        Targets() { fill(make_index_sequence<kMaxTargets>()); }
+        ~Targets() { for (Observer *o : observers) delete o; }
+
+        template <size_t... K>
+        void fill(index_sequence<K...>)
+        {
+            ((pointers[K] = callback<K>), ...);
+            ((observers[K] = new Target<K>()), ...);
+            ((functions[K] = [](const char *s) { callback<K>(s); }), ...);
+            ((functors[K] = Functor<K>()), ...);
+            ((delegates[K] = [](const char *s) { callback<K>(s); }), ...);
+        }
+    };
+
+
+#ifdef __linux__
+    class BranchMissCounter {
+    public:
+        BranchMissCounter()
+        {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+
+            m_fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+
+        ~BranchMissCounter() { if (m_fd >= 0) close(m_fd); }
+
+        bool available() const { return m_fd >= 0; }
+
+        void start()
+        {
+            ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+
+        uint64_t stop()
+        {
+            ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+
+            uint64_t count = 0;
+            return read(m_fd, &count, sizeof(count)) == sizeof(count) ? count : 0;
+        }
+
+    private:
+        int m_fd;
+    };
+#else
+    class BranchMissCounter {
+    public:
+        bool available() const { return false; }
+        void start() {}
+        uint64_t stop() { return 0; }
+    };
+#endif
+
+
+    struct Result {
+        double ns;
+        double misses;
+    };
+
+    // calls call(target) for every entry of the site sequence, kRepeat times
+    template <typename Call>
+    Result measure(const vector<uint8_t>& site, BranchMissCounter& counter, Call call)
+    {
+        const char *const input = "event";
+
+        // warm up caches and predictors
+        for (uint8_t target : site)
+        {
+            call(target, input);
+        }
+
+        if (counter.available())
+            counter.start();
+
+        const auto start = chrono::steady_clock::now();
+
+        for (uint32_t r = 0; r < kRepeat; r++)
+        {
+            for (uint8_t target : site)
+            {
+                call(target, input);
+            }
+        }
+
+        const chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+        const uint64_t misses = counter.available() ? counter.stop() : 0;
+        const double calls = static_cast<double>(site.size()) * kRepeat;
+
+        return Result{ elapsed.count() / calls, misses / calls };
+    }
+
+} // namespace anonymouse
+
+
+int main()
+{
+    Targets targets;
+    BranchMissCounter counter;
+
+    vector<uint8_t> sites[3];
+    srand(0);
+
+    for (uint32_t s = 0; s < 3; s++)
+    {
+        sites[s].resize(kSiteSize);
+
+        for (uint8_t& target : sites[s])
+        {
+            target = static_cast<uint8_t>(rand() % kTargetCounts[s]);
+        }
+    }
+
+    VPRINTF("%u calls per site; targets picked at random from 1 / 4 / 64\n", kSiteSize * kRepeat);
+    VPRINTF("%-16s %10s %10s %10s   %10s %10s %10s\n", "", "ns mono", "ns poly", "ns mega", "miss mono", "miss poly", "miss mega");
+
+    // mono: the call for the single-target site, call: for the other two
+    const auto splitRow = [&](const char *name, auto mono, auto call) {
+        Result results[3];
+        results[0] = measure(sites[0], counter, mono);
+
+        for (uint32_t s = 1; s < 3; s++)
+        {
+            results[s] = measure(sites[s], counter, call);
+        }
+
+        VPRINTF("%-16s %10.2f %10.2f %10.2f", name, results[0].ns, results[1].ns, results[2].ns);
+
+        if (counter.available())
+            VPRINTF("   %10.3f %10.3f %10.3f\n", results[0].misses, results[1].misses, results[2].misses);
+        else
+            VPRINTF("   %10s %10s %10s\n", "n/a", "n/a", "n/a");
+    };
+
+    const auto row = [&](const char *name, auto call) { splitRow(name, call, call); };
+
+    row("FUNC_POINTER", [&targets](uint8_t t, const char *s) { targets.pointers[t](s); });
+    row("virtual", [&targets](uint8_t t, const char *s) { targets.observers[t]->onNotify(s); });
+    row("std::function", [&targets](uint8_t t, const char *s) { targets.functions[t](s); });
+    // a single type is known statically, so the call inlines and the loop
+    // may fold away entirely (~0 ns); more types need a visit
+    splitRow("template",
+        [](uint8_t, const char *s) { Functor<0>()(s); },
+        [&targets](uint8_t t, const char *s) { visit([s](const auto& f) { f(s); }, targets.functors[t]); });
+    row("Delegate", [&targets](uint8_t t, const char *s) { targets.delegates[t](s); });
+
+    if (!counter.available())
+        VPRINTF("perf_event_open() unavailable; branch misses not measured\n");
+
+    VPRINTF("(%llu)\n", static_cast<unsigned long long>(g_sink));
+
+    return 0;
+}
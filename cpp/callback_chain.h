@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "memory_allocator.h"
+
+namespace Mif {
+
+    // Length-carrying callback signatures: unlike FUNC_POINTER's const char*,
+    // the input needs no terminator and is never rescanned for its length.
+    // context is the state the callback was bound with.
+    typedef void (*TextCallbackFunc)(void* context, std::string_view input);
+    typedef void (*BytesCallbackFunc)(void* context, std::span<const std::byte> input);
+
+
+    // A callback bound to its context.
+    template <typename View>
+    struct ViewCallback {
+        void (*func)(void* context, View input);
+        void* context;
+
+        void operator()(View input) const { func(context, input); }
+    };
+
+    typedef ViewCallback<std::string_view> TextCallback;
+    typedef ViewCallback<std::span<const std::byte>> BytesCallback;
+
+
+    // Runs a payload through a chain of stages without copying it.
+    //
+    // Each stage receives a view and returns the view for the next stage.
+    // A stage that only looks at, or narrows, its input returns the input or
+    // a subview of it. A stage that really produces new bytes allocates them
+    // from the chain's arena and returns a view of those. Nothing is copied
+    // between stages, and the result of run() stays valid until the arena is
+    // rewound, typically once per message:
+    //
+    //     void* const marker = arena.getCurrent();
+    //     consume(chain.run(payload));
+    //     arena.freeToMarker(marker);
+    template <typename View>
+    class CallbackChain {
+    public:
+        typedef View (*StageFunc)(void* context, View input, StackAllocator& arena);
+
+        explicit CallbackChain(StackAllocator& arena)
+        : m_arena(arena)
+        {
+            ;
+        }
+
+        // stages run in the order they were added
+        void add(StageFunc stage, void* context = nullptr)
+        {
+            assert(stage != nullptr);
+            m_stages.push_back(Stage{ stage, context, ViewCallback<View>{ nullptr, nullptr } });
+        }
+
+        // a stage that only observes the payload and passes it on unchanged
+        void add(ViewCallback<View> callback)
+        {
+            assert(callback.func != nullptr);
+            m_stages.push_back(Stage{ nullptr, nullptr, callback });
+        }
+
+        View run(View input) const
+        {
+            for (const Stage& stage : m_stages)
+            {
+                if (stage.transform)
+                    input = stage.transform(stage.context, input, m_arena);
+                else
+                    stage.observe(input);
+            }
+
+            return input;
+        }
+
+        size_t numStages() const { return m_stages.size(); }
+
+        // a buffer the caller can fill, e.g. by read(), before handing it to run()
+        std::span<std::byte> allocate(size_t size, size_t alignment = alignof(std::max_align_t))
+        {
+            return std::span<std::byte>(static_cast<std::byte*>(m_arena.alloc(size, alignment)), size);
+        }
+
+        StackAllocator& arena() const { return m_arena; }
+
+    private:
+        struct Stage {
+            StageFunc transform;
+            void* context;
+            ViewCallback<View> observe;
+        };
+
+        StackAllocator& m_arena;
+        std::vector<Stage> m_stages;
+    };
+
+    typedef CallbackChain<std::string_view> TextChain;
+    typedef CallbackChain<std::span<const std::byte>> BytesChain;
+
+} // namespace Mif
@@ -0,0 +1,111 @@
+#include <cctype>
+#include <cstring>
+#include <string>
+#include "callback_chain.h"
+#include "gtest/gtest.h"
+
+namespace { // for constants
+    const size_t kArenaSize = 4096;
+} // namespace anonymouse
+
+namespace { // for test fixture
+    class CallbackChainTest : public ::testing::Test
+    {
+    public:
+        CallbackChainTest() : arena_(memory_, kArenaSize) {}
+
+        bool inArena(const void* p) const { return p >= memory_ && p < memory_ + kArenaSize; }
+
+        alignas(16) char memory_[kArenaSize];
+        Mif::StackAllocator arena_;
+    };
+
+    std::string_view trim(void*, std::string_view input, Mif::StackAllocator&)
+    {
+        const size_t first = input.find_first_not_of(' ');
+
+        if (first == std::string_view::npos)
+            return std::string_view();
+
+        return input.substr(first, input.find_last_not_of(' ') - first + 1);
+    }
+
+    std::string_view upper(void*, std::string_view input, Mif::StackAllocator& arena)
+    {
+        char* const out = static_cast<char*>(arena.alloc(input.size(), 1));
+
+        for (size_t i = 0; i < input.size(); i++)
+        {
+            out[i] = static_cast<char>(toupper(static_cast<unsigned char>(input[i])));
+        }
+
+        return std::string_view(out, input.size());
+    }
+
+    void record(void* context, std::string_view input)
+    {
+        static_cast<std::string*>(context)->append(input).append("|");
+    }
+
+    // drops a length prefix, then keeps exactly that many bytes
+    std::span<const std::byte> unframe(void* context, std::span<const std::byte> input, Mif::StackAllocator&)
+    {
+        uint32_t length;
+        memcpy(&length, input.data(), sizeof(length));
+        ++*static_cast<uint32_t*>(context);
+        return input.subspan(sizeof(length), length);
+    }
+} // namespace anonymouse
+
+
+namespace { // for functions
+
+    TEST_F(CallbackChainTest, textStagesShareOrAllocate)
+    {
+        std::string seen;
+
+        Mif::TextChain chain(arena_);
+        chain.add(trim);
+        chain.add(Mif::TextCallback{ record, &seen });
+        chain.add(upper);
+        chain.add(Mif::TextCallback{ record, &seen });
+        EXPECT_EQ(chain.numStages(), 4);
+
+        // not terminated where the view ends
+        const char text[] = "  hello world  and more";
+        const std::string_view input(text, 15);
+
+        void* const marker = arena_.getCurrent();
+        const std::string_view result = chain.run(input);
+
+        EXPECT_EQ(seen, "hello world|HELLO WORLD|");
+        EXPECT_EQ(result, "HELLO WORLD");
+        EXPECT_TRUE(inArena(result.data()));
+        EXPECT_EQ(arena_.getSizeInBytes(), result.size());
+
+        arena_.freeToMarker(marker);
+        EXPECT_EQ(arena_.getSizeInBytes(), 0);
+    }
+
+
+    TEST_F(CallbackChainTest, bytesNarrowWithoutCopying)
+    {
+        uint32_t calls = 0;
+
+        Mif::BytesChain chain(arena_);
+        chain.add(unframe, &calls);
+
+        const std::span<std::byte> buffer = chain.allocate(16);
+        const uint32_t length = 5;
+        memcpy(buffer.data(), &length, sizeof(length));
+        memcpy(buffer.data() + sizeof(length), "payload", 7);
+
+        const std::span<const std::byte> result = chain.run(buffer);
+
+        EXPECT_EQ(calls, 1);
+        EXPECT_EQ(result.size(), length);
+        EXPECT_EQ(result.data(), buffer.data() + sizeof(length));
+        EXPECT_EQ(memcmp(result.data(), "paylo", length), 0);
+    }
+
+} // namespace anonymouse
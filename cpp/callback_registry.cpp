@@ -0,0 +1,99 @@
+#include <cassert>
+#include "callback_registry.h"
+
+namespace Mif {
+
+    CallbackRegistry::CallbackRegistry(uint32_t numTopics)
+    : m_start(numTopics + 1, 0)
+    {
+        ;
+    }
+
+
+    void CallbackRegistry::add(TopicId topic, CallbackFunc callback)
+    {
+        assert(callback != nullptr);
+        insert(topic, Entry{ callback, nullptr });
+    }
+
+
+    void CallbackRegistry::add(TopicId topic, BatchCallbackFunc callback)
+    {
+        assert(callback != nullptr);
+        insert(topic, Entry{ nullptr, callback });
+    }
+
+
+    bool CallbackRegistry::remove(TopicId topic, CallbackFunc callback)
+    {
+        return erase(topic, Entry{ callback, nullptr });
+    }
+
+
+    bool CallbackRegistry::remove(TopicId topic, BatchCallbackFunc callback)
+    {
+        return erase(topic, Entry{ nullptr, callback });
+    }
+
+
+    void CallbackRegistry::invoke(TopicId topic, const char* const* inputs, uint32_t count) const
+    {
+        assert(topic < numTopics() && "unknown topic");
+
+        const Entry* const begin = m_entries.data() + m_start[topic];
+        const Entry* const end = m_entries.data() + m_start[topic + 1];
+
+        for (const Entry* e = begin; e != end; e++)
+        {
+            if (e->batch)
+            {
+                e->batch(inputs, count);
+                continue;
+            }
+
+            const CallbackFunc single = e->single;
+
+            for (uint32_t i = 0; i < count; i++)
+            {
+                single(inputs[i]);
+            }
+        }
+    }
+
+
+    void CallbackRegistry::insert(TopicId topic, const Entry& entry)
+    {
+        assert(topic < numTopics() && "unknown topic");
+
+        m_entries.insert(m_entries.begin() + m_start[topic + 1], entry);
+
+        for (size_t t = topic + 1; t < m_start.size(); t++)
+        {
+            m_start[t]++;
+        }
+    }
+
+
+    bool CallbackRegistry::erase(TopicId topic, const Entry& entry)
+    {
+        assert(topic < numTopics() && "unknown topic");
+
+        for (uint32_t i = m_start[topic]; i < m_start[topic + 1]; i++)
+        {
+            if (m_entries[i].single == entry.single && m_entries[i].batch == entry.batch)
+            {
+                m_entries.erase(m_entries.begin() + i);
+
+                for (size_t t = topic + 1; t < m_start.size(); t++)
+                {
+                    m_start[t]--;
+                }
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+} // namespace Mif
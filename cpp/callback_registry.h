@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Mif {
+
+    typedef uint32_t TopicId;
+
+    // same shape as FUNC_POINTER in callback.cpp
+    typedef void (*CallbackFunc)(const char* input);
+
+    // receives a whole batch in one call
+    typedef void (*BatchCallbackFunc)(const char* const* inputs, uint32_t count);
+
+
+    // Callbacks registered per topic, for hooks that are called very often.
+    //
+    // All callbacks live in one array grouped by topic, with an offset table
+    // per topic, so invoking a topic walks a contiguous run. invoke() over an
+    // array of inputs is callback-major: each callback gets every input
+    // before the next callback runs. A BatchCallbackFunc gets them in one
+    // call; a plain CallbackFunc is called in a tight loop whose indirect
+    // target never changes, so the branch predictor gets it right after the
+    // first input.
+    //
+    // Registration shifts the array and is meant for setup time, not for the
+    // invocation path.
+    class CallbackRegistry {
+    public:
+        explicit CallbackRegistry(uint32_t numTopics);
+
+        // callbacks of a topic run in registration order
+        void add(TopicId topic, CallbackFunc callback);
+        void add(TopicId topic, BatchCallbackFunc callback);
+
+        // removes the first registration of callback; false if there is none
+        bool remove(TopicId topic, CallbackFunc callback);
+        bool remove(TopicId topic, BatchCallbackFunc callback);
+
+        void invoke(TopicId topic, const char* input) const { invoke(topic, &input, 1); }
+        void invoke(TopicId topic, const char* const* inputs, uint32_t count) const;
+
+        uint32_t numCallbacks(TopicId topic) const { return m_start[topic + 1] - m_start[topic]; }
+        uint32_t numTopics() const { return static_cast<uint32_t>(m_start.size()) - 1; }
+
+    private:
+        // exactly one of the two is set
+        struct Entry {
+            CallbackFunc single;
+            BatchCallbackFunc batch;
+        };
+
+        void insert(TopicId topic, const Entry& entry);
+        bool erase(TopicId topic, const Entry& entry);
+
+        std::vector<uint32_t> m_start;  // numTopics + 1 offsets into m_entries
+        std::vector<Entry> m_entries;
+    };
+
+} // namespace Mif
@@ -0,0 +1,80 @@
+#include <string>
+#include <vector>
+#include "callback_registry.h"
+#include "gtest/gtest.h"
+
+namespace { // for constants
+    const uint32_t kNumTopics = 3;
+} // namespace anonymouse
+
+namespace { // for test fixture
+    std::vector<std::string> g_calls;
+
+    void first(const char* s) { g_calls.push_back(std::string("first ") + s); }
+    void second(const char* s) { g_calls.push_back(std::string("second ") + s); }
+
+    void batch(const char* const* inputs, uint32_t count)
+    {
+        g_calls.push_back("batch " + std::to_string(count) + " " + inputs[0]);
+    }
+
+    class CallbackRegistryTest : public ::testing::Test
+    {
+    public:
+        CallbackRegistryTest() : registry_(kNumTopics) {}
+
+        void SetUp() { g_calls.clear(); }
+
+        Mif::CallbackRegistry registry_;
+    };
+} // namespace anonymouse
+
+
+namespace { // for functions
+
+    TEST_F(CallbackRegistryTest, callbackMajorOrder)
+    {
+        registry_.add(1, first);
+        registry_.add(2, second);
+        registry_.add(1, batch);
+        registry_.add(1, second);
+
+        EXPECT_EQ(registry_.numCallbacks(0), 0);
+        EXPECT_EQ(registry_.numCallbacks(1), 3);
+        EXPECT_EQ(registry_.numCallbacks(2), 1);
+
+        const char* const inputs[] = { "a", "b" };
+        registry_.invoke(1, inputs, 2);
+
+        const std::vector<std::string> expected = { "first a", "first b", "batch 2 a", "second a", "second b" };
+        EXPECT_EQ(g_calls, expected);
+
+        // other topics are untouched
+        g_calls.clear();
+        registry_.invoke(0, "x");
+        registry_.invoke(2, "y");
+        EXPECT_EQ(g_calls, std::vector<std::string>{ "second y" });
+    }
+
+
+    TEST_F(CallbackRegistryTest, remove)
+    {
+        registry_.add(0, first);
+        registry_.add(0, first);
+        registry_.add(1, second);
+        registry_.add(2, batch);
+
+        EXPECT_TRUE(registry_.remove(0, first));
+        EXPECT_EQ(registry_.numCallbacks(0), 1);
+        EXPECT_FALSE(registry_.remove(1, first));
+        EXPECT_FALSE(registry_.remove(1, batch));
+        EXPECT_TRUE(registry_.remove(2, batch));
+
+        registry_.invoke(0, "a");
+        registry_.invoke(1, "b");
+        registry_.invoke(2, "c");
+
+        EXPECT_EQ(g_calls, (std::vector<std::string>{ "first a", "second b" }));
+    }
+
+} // namespace anonymouse
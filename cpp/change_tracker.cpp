@@ -0,0 +1,66 @@
+#include <cassert>
+#include <cstring>
+#include "change_tracker.h"
+
+namespace Mif {
+
+    void DirtyBits::pack(const uint8_t* bytes, uint32_t count)
+    {
+        resize(count);
+
+        uint32_t i = 0;
+
+        for (; i + 8 <= count; i += 8)
+        {
+            uint64_t chunk;
+            std::memcpy(&chunk, bytes + i, sizeof(chunk));
+
+            // gathers bit 0 of each byte into the top byte (little endian)
+            const uint64_t packed = ((chunk & 0x0101010101010101ull) * 0x0102040810204080ull) >> 56;
+            m_words[i >> 6] |= packed << (i & 63);
+        }
+
+        for (; i < count; i++)
+        {
+            if (bytes[i])
+                set(i);
+        }
+    }
+
+
+    void ChangeTracker::capture(const EntityStore& store)
+    {
+        m_before.pack(store.onSurface(), store.size());
+    }
+
+
+    uint32_t ChangeTracker::detect(const EntityStore& store)
+    {
+        assert(m_before.count() == store.size() && "entities were created or destroyed since capture()");
+
+        m_after.pack(store.onSurface(), store.size());
+        m_dirty.resize(store.size());
+
+        const uint64_t* const before = m_before.words();
+        const uint64_t* const after = m_after.words();
+        uint64_t* const dirty = m_dirty.words();
+
+        for (uint32_t w = 0; w < m_dirty.numWords(); w++)
+        {
+            dirty[w] = before[w] ^ after[w];
+        }
+
+        const size_t first = m_changes.size();
+
+        m_dirty.forEachSet([this, &store](uint32_t i) {
+            const StateChange change = {
+                store.idAt(i),
+                m_after.test(i) ? Transition::LANDED : Transition::LEFT_SURFACE
+            };
+            m_changes.push_back(change);
+        });
+
+        return static_cast<uint32_t>(m_changes.size() - first);
+    }
+
+} // namespace Mif
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "entity_store.h"
+
+namespace Mif {
+
+    // One bit per entity, 64 entities per word.
+    class DirtyBits {
+    public:
+        void resize(uint32_t count) { m_words.assign((count + 63) / 64, 0); m_count = count; }
+        void clearAll() { m_words.assign(m_words.size(), 0); }
+
+        void set(uint32_t i) { m_words[i >> 6] |= 1ull << (i & 63); }
+        void reset(uint32_t i) { m_words[i >> 6] &= ~(1ull << (i & 63)); }
+        bool test(uint32_t i) const { return (m_words[i >> 6] >> (i & 63)) & 1; }
+
+        // packs 0/1 bytes, 8 at a time
+        void pack(const uint8_t* bytes, uint32_t count);
+
+        uint32_t count() const { return m_count; }
+        uint32_t numWords() const { return static_cast<uint32_t>(m_words.size()); }
+        uint64_t* words() { return m_words.data(); }
+        const uint64_t* words() const { return m_words.data(); }
+
+        // calls f(index) for every set bit, in increasing order
+        template <typename F>
+        void forEachSet(F f) const;
+
+    private:
+        std::vector<uint64_t> m_words;
+        uint32_t m_count = 0;
+    };
+
+
+    template <typename F>
+    void DirtyBits::forEachSet(F f) const
+    {
+        for (uint32_t w = 0; w < m_words.size(); w++)
+        {
+            // whole clean words are skipped with one compare
+            for (uint64_t bits = m_words[w]; bits != 0; bits &= bits - 1)
+            {
+                f((w << 6) + static_cast<uint32_t>(__builtin_ctzll(bits)));
+            }
+        }
+    }
+
+
+    enum class Transition : uint8_t {
+        LANDED,        // in the air -> on a surface
+        LEFT_SURFACE,  // on a surface -> in the air
+    };
+
+    struct StateChange {
+        EntityId entity;
+        Transition transition;
+    };
+
+
+    // Change detection for the on-surface state of an EntityStore.
+    // capture() packs the state before a step; detect() packs it again,
+    // XORs the two bitsets into a dirty set and turns only the dirty bits
+    // into StateChanges. Entities whose state did not change cost one bit
+    // each and produce no event.
+    class ChangeTracker {
+    public:
+        void capture(const EntityStore& store);
+        uint32_t detect(const EntityStore& store);
+
+        const DirtyBits& dirty() const { return m_dirty; }
+        const std::vector<StateChange>& changes() const { return m_changes; }
+        void clearChanges() { m_changes.clear(); }
+
+    private:
+        DirtyBits m_before;
+        DirtyBits m_after;
+        DirtyBits m_dirty;
+        std::vector<StateChange> m_changes;
+    };
+
+} // namespace Mif
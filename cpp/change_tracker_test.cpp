@@ -0,0 +1,108 @@
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "change_tracker.h"
+#include "gtest/gtest.h"
+
+namespace { // for constants
+    const uint32_t kNumEntities = 200 + 7; // leaves a partial word and a partial byte chunk
+} // namespace anonymouse
+
+
+namespace { // for functions
+
+    TEST(DirtyBitsTest, pack)
+    {
+        std::vector<uint8_t> bytes(kNumEntities);
+
+        for (uint32_t i = 0; i < kNumEntities; i++)
+        {
+            bytes[i] = rand() % 2;
+        }
+
+        Mif::DirtyBits bits;
+        bits.pack(bytes.data(), kNumEntities);
+
+        EXPECT_EQ(bits.count(), kNumEntities);
+        EXPECT_EQ(bits.numWords(), (kNumEntities + 63) / 64);
+
+        for (uint32_t i = 0; i < kNumEntities; i++)
+        {
+            EXPECT_EQ(bits.test(i), bytes[i] == 1) << i;
+        }
+    }
+
+
+    TEST(DirtyBitsTest, forEachSet)
+    {
+        Mif::DirtyBits bits;
+        bits.resize(kNumEntities);
+
+        const uint32_t expected[] = { 0, 5, 63, 64, 130, kNumEntities - 1 };
+
+        for (uint32_t i : expected)
+        {
+            bits.set(i);
+        }
+
+        bits.set(7);
+        bits.reset(7);
+
+        std::vector<uint32_t> visited;
+        bits.forEachSet([&visited](uint32_t i) { visited.push_back(i); });
+
+        EXPECT_EQ(visited, std::vector<uint32_t>(std::begin(expected), std::end(expected)));
+
+        bits.clearAll();
+        visited.clear();
+        bits.forEachSet([&visited](uint32_t i) { visited.push_back(i); });
+        EXPECT_TRUE(visited.empty());
+    }
+
+
+    TEST(ChangeTrackerTest, onlyTransitions)
+    {
+        Mif::EntityStore store;
+        std::vector<Mif::EntityId> ids;
+
+        for (uint32_t i = 0; i < kNumEntities; i++)
+        {
+            ids.push_back(store.create(0.0f, 0.0f));  // all on the ground
+        }
+
+        Mif::ChangeTracker tracker;
+
+        // nothing moves, nothing is reported
+        tracker.capture(store);
+        store.updateAll(0.1f);
+        EXPECT_EQ(tracker.detect(store), 0);
+        EXPECT_TRUE(tracker.changes().empty());
+
+        // two entities jump
+        store.velY()[store.indexOf(ids[3])] = 10.0f;
+        store.velY()[store.indexOf(ids[100])] = 10.0f;
+
+        tracker.capture(store);
+        store.updateAll(0.1f);
+        EXPECT_EQ(tracker.detect(store), 2);
+
+        ASSERT_EQ(tracker.changes().size(), 2);
+        EXPECT_EQ(tracker.changes()[0].entity, ids[3]);
+        EXPECT_EQ(tracker.changes()[0].transition, Mif::Transition::LEFT_SURFACE);
+        EXPECT_EQ(tracker.changes()[1].entity, ids[100]);
+        EXPECT_TRUE(tracker.dirty().test(store.indexOf(ids[100])));
+        EXPECT_FALSE(tracker.dirty().test(store.indexOf(ids[4])));
+
+        // and come back down
+        tracker.clearChanges();
+        store.velY()[store.indexOf(ids[3])] = -100.0f;
+        store.velY()[store.indexOf(ids[100])] = -100.0f;
+
+        tracker.capture(store);
+        store.updateAll(0.1f);
+        EXPECT_EQ(tracker.detect(store), 2);
+        EXPECT_EQ(tracker.changes()[0].transition, Mif::Transition::LANDED);
+        EXPECT_EQ(tracker.changes()[1].transition, Mif::Transition::LANDED);
+    }
+
+} // namespace anonymouse
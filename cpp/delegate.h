@@ -0,0 +1,238 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// reference: https://www.codeproject.com/Articles/11015/The-Impossibly-Fast-C-Delegates
+
+namespace Mif {
+
+    template <typename Signature, size_t kStorageSize = 3 * sizeof(void*)>
+    class Delegate;
+
+    // Type-erased callable like std::function, but callables up to
+    // kStorageSize bytes are stored inline, so binding a small capturing
+    // lambda never allocates. Larger callables fall back to the heap.
+    // Trivially copyable inline callables (function pointers, lambdas
+    // capturing pointers/references) are copied with memcpy and need no
+    // destructor call.
+    template <typename R, typename... Args, size_t kStorageSize>
+    class Delegate<R(Args...), kStorageSize> {
+    public:
+        Delegate()
+        : m_invoke(nullptr)
+        , m_manage(nullptr)
+        {
+            ;
+        }
+
+        Delegate(std::nullptr_t) : Delegate() {}
+
+        template <typename F,
+                  typename = typename std::enable_if<
+                      !std::is_same<typename std::decay<F>::type, Delegate>::value
+                      && std::is_invocable_r<R, typename std::decay<F>::type&, Args...>::value>::type>
+        Delegate(F&& f)
+        : Delegate()
+        {
+            assign(std::forward<F>(f));
+        }
+
+        Delegate(const Delegate& other)
+        : Delegate()
+        {
+            copyFrom(other);
+        }
+
+        Delegate(Delegate&& other)
+        : Delegate()
+        {
+            moveFrom(other);
+        }
+
+        ~Delegate() { reset(); }
+
+        Delegate& operator=(const Delegate& other)
+        {
+            if (this != &other)
+            {
+                reset();
+                copyFrom(other);
+            }
+            return *this;
+        }
+
+        Delegate& operator=(Delegate&& other)
+        {
+            if (this != &other)
+            {
+                reset();
+                moveFrom(other);
+            }
+            return *this;
+        }
+
+        void reset()
+        {
+            if (m_manage)
+                m_manage(Op::DESTROY, m_storage, nullptr);
+
+            m_invoke = nullptr;
+            m_manage = nullptr;
+        }
+
+        R operator()(Args... args) const
+        {
+            assert(m_invoke && "calling an empty Delegate");
+            return m_invoke(const_cast<unsigned char*>(m_storage), std::forward<Args>(args)...);
+        }
+
+        explicit operator bool() const { return m_invoke != nullptr; }
+
+        // true when no copy/destroy hook is needed (inline and trivially copyable)
+        bool isTrivial() const { return m_manage == nullptr; }
+
+        template <typename F>
+        static constexpr bool fitsInline()
+        {
+            return sizeof(F) <= kStorageSize
+                && alignof(F) <= alignof(std::max_align_t)
+                && std::is_nothrow_move_constructible<F>::value;
+        }
+
+    private:
+        enum class Op { COPY, MOVE, DESTROY };
+
+        typedef R (*Invoke)(void* storage, Args... args);
+        typedef void (*Manage)(Op op, void* dst, void* src);
+
+        template <typename F>
+        void assign(F&& f);
+
+        void copyFrom(const Delegate& other);
+        void moveFrom(Delegate& other);
+
+        template <typename F>
+        static R invokeInline(void* storage, Args... args)
+        {
+            return (*static_cast<F*>(storage))(std::forward<Args>(args)...);
+        }
+
+        template <typename F>
+        static R invokeHeap(void* storage, Args... args)
+        {
+            return (**static_cast<F**>(storage))(std::forward<Args>(args)...);
+        }
+
+        template <typename F>
+        static void manageInline(Op op, void* dst, void* src);
+
+        template <typename F>
+        static void manageHeap(Op op, void* dst, void* src);
+
+        alignas(std::max_align_t) unsigned char m_storage[kStorageSize];
+        Invoke m_invoke;
+        Manage m_manage;  // null for trivially copyable inline callables
+    };
+
+
+    template <typename R, typename... Args, size_t kStorageSize>
+    template <typename F>
+    void Delegate<R(Args...), kStorageSize>::assign(F&& f)
+    {
+        typedef typename std::decay<F>::type Callable;
+
+        static_assert(sizeof(Callable*) <= kStorageSize, "storage must hold at least a pointer");
+
+        if constexpr (fitsInline<Callable>())
+        {
+            new (m_storage) Callable(std::forward<F>(f));
+            m_invoke = &invokeInline<Callable>;
+            m_manage = std::is_trivially_copyable<Callable>::value ? nullptr : &manageInline<Callable>;
+        }
+        else
+        {
+            *reinterpret_cast<Callable**>(m_storage) = new Callable(std::forward<F>(f));
+            m_invoke = &invokeHeap<Callable>;
+            m_manage = &manageHeap<Callable>;
+        }
+    }
+
+
+    template <typename R, typename... Args, size_t kStorageSize>
+    void Delegate<R(Args...), kStorageSize>::copyFrom(const Delegate& other)
+    {
+        if (other.m_manage)
+            other.m_manage(Op::COPY, m_storage, const_cast<unsigned char*>(other.m_storage));
+        else
+            std::memcpy(m_storage, other.m_storage, kStorageSize);
+
+        m_invoke = other.m_invoke;
+        m_manage = other.m_manage;
+    }
+
+
+    template <typename R, typename... Args, size_t kStorageSize>
+    void Delegate<R(Args...), kStorageSize>::moveFrom(Delegate& other)
+    {
+        if (other.m_manage)
+            other.m_manage(Op::MOVE, m_storage, other.m_storage);
+        else
+            std::memcpy(m_storage, other.m_storage, kStorageSize);
+
+        m_invoke = other.m_invoke;
+        m_manage = other.m_manage;
+
+        // ownership moved, so the source has nothing left to destroy
+        other.m_invoke = nullptr;
+        other.m_manage = nullptr;
+    }
+
+
+    template <typename R, typename... Args, size_t kStorageSize>
+    template <typename F>
+    void Delegate<R(Args...), kStorageSize>::manageInline(Op op, void* dst, void* src)
+    {
+        switch (op)
+        {
+        case Op::COPY:
+            new (dst) F(*static_cast<const F*>(src));
+            break;
+
+        case Op::MOVE:
+            new (dst) F(std::move(*static_cast<F*>(src)));
+            static_cast<F*>(src)->~F();
+            break;
+
+        case Op::DESTROY:
+            static_cast<F*>(dst)->~F();
+            break;
+        }
+    }
+
+
+    template <typename R, typename... Args, size_t kStorageSize>
+    template <typename F>
+    void Delegate<R(Args...), kStorageSize>::manageHeap(Op op, void* dst, void* src)
+    {
+        switch (op)
+        {
+        case Op::COPY:
+            *static_cast<F**>(dst) = new F(**static_cast<const F* const*>(src));
+            break;
+
+        case Op::MOVE:
+            *static_cast<F**>(dst) = *static_cast<F**>(src);
+            break;
+
+        case Op::DESTROY:
+            delete *static_cast<F**>(dst);
+            break;
+        }
+    }
+
+} // namespace Mif
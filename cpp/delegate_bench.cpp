@@ -0,0 +1,89 @@
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+#include <functional>
+#include "delegate.h"
+
+using namespace std;
+
+// Call overhead of Mif::Delegate compared to a raw function pointer,
+// std::function and a virtual call. The call targets are not inlinable
+// and are picked through a volatile index, so that the compiler cannot
+// devirtualize or hoist any of them.
+
+#define VPRINTF(...) \
+    do { \
+        printf(__VA_ARGS__); \
+    } while (false)
+
+namespace {
+
+    const uint64_t kIterations = 200 * 1000 * 1000;
+
+    typedef uint64_t (*FUNC_POINTER)(uint64_t);
+
+    __attribute__((noinline)) uint64_t addOne(uint64_t x)
+    {
+        return x + 1;
+    }
+
+    class Base
+    {
+    public:
+        virtual ~Base() {}
+        virtual uint64_t call(uint64_t x) = 0;
+    };
+
+    class Derived : public Base
+    {
+    public:
+        __attribute__((noinline)) virtual uint64_t call(uint64_t x) { return x + 1; }
+    };
+
+    template <typename F>
+    double measure(const char* name, F f)
+    {
+        uint64_t x = 0;
+        const auto start = chrono::steady_clock::now();
+
+        for (uint64_t i = 0; i < kIterations; i++)
+        {
+            x = f(x);
+        }
+
+        const chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+        const double ns = elapsed.count() / kIterations;
+
+        VPRINTF("%-24s %8.3f ns/call (%llu)\n", name, ns, (unsigned long long)x);
+
+        return ns;
+    }
+
+} // namespace anonymouse
+
+
+int main()
+{
+    volatile int index = 0;
+
+    FUNC_POINTER pointers[] = { addOne };
+    const FUNC_POINTER pointer = pointers[index];
+
+    Derived derived;
+    Base* objects[] = { &derived };
+    Base* const object = objects[index];
+
+    const uint64_t step = 1 + index;
+
+    const function<uint64_t(uint64_t)> stdFunction = [step](uint64_t x) { return addOne(x) + step - 1; };
+    const Mif::Delegate<uint64_t(uint64_t)> delegate = [step](uint64_t x) { return addOne(x) + step - 1; };
+    const Mif::Delegate<uint64_t(uint64_t)> delegatePointer = pointer;
+
+    measure("function pointer", [pointer](uint64_t x) { return pointer(x); });
+    measure("virtual call", [object](uint64_t x) { return object->call(x); });
+    measure("std::function (lambda)", [&stdFunction](uint64_t x) { return stdFunction(x); });
+    measure("Delegate (lambda)", [&delegate](uint64_t x) { return delegate(x); });
+    measure("Delegate (pointer)", [&delegatePointer](uint64_t x) { return delegatePointer(x); });
+
+    return 0;
+}
@@ -0,0 +1,174 @@
+#include <cstdio>
+#include <string>
+#include <type_traits>
+#include "delegate.h"
+#include "gtest/gtest.h"
+
+namespace { // for constants
+    typedef Mif::Delegate<int(int)> IntDelegate;
+
+    int twice(int x)
+    {
+        return x * 2;
+    }
+
+    // counts live instances to check copy/move/destroy hooks
+    struct Tracked
+    {
+        static int alive;
+
+        explicit Tracked(int offset) : offset_(offset) { alive++; }
+        Tracked(const Tracked& other) : offset_(other.offset_) { alive++; }
+        Tracked(Tracked&& other) noexcept : offset_(other.offset_) { alive++; }
+        ~Tracked() { alive--; }
+
+        int operator()(int x) const { return x + offset_; }
+
+        int offset_;
+    };
+
+    int Tracked::alive = 0;
+
+    struct Large
+    {
+        char padding[128];
+        int operator()(int x) const { return x + padding[0]; }
+    };
+} // namespace anonymouse
+
+
+namespace { // for functions
+
+    TEST(DelegateTest, empty)
+    {
+        IntDelegate d;
+        EXPECT_FALSE(d);
+
+        IntDelegate n(nullptr);
+        EXPECT_FALSE(n);
+    }
+
+
+    TEST(DelegateTest, functionPointer)
+    {
+        IntDelegate d(twice);
+
+        EXPECT_TRUE(d);
+        EXPECT_TRUE(d.isTrivial());
+        EXPECT_EQ(d(21), 42);
+
+        IntDelegate copy(d);
+        EXPECT_EQ(copy(4), 8);
+    }
+
+
+    TEST(DelegateTest, capturingLambda)
+    {
+        int calls = 0;
+        const int offset = 10;
+
+        IntDelegate d([&calls, offset](int x) {
+            calls++;
+            return x + offset;
+        });
+
+        EXPECT_TRUE(d.isTrivial());
+        EXPECT_EQ(d(1), 11);
+
+        IntDelegate copy = d;
+        EXPECT_EQ(copy(2), 12);
+        EXPECT_EQ(calls, 2);
+    }
+
+
+    TEST(DelegateTest, mutableLambda)
+    {
+        IntDelegate d([n = 0](int x) mutable { return n += x; });
+
+        EXPECT_EQ(d(1), 1);
+        EXPECT_EQ(d(2), 3);
+    }
+
+
+    TEST(DelegateTest, nonTrivialInline)
+    {
+        EXPECT_TRUE(IntDelegate::fitsInline<Tracked>());
+
+        {
+            IntDelegate d(Tracked(5));
+            EXPECT_FALSE(d.isTrivial());
+            EXPECT_EQ(Tracked::alive, 1);
+            EXPECT_EQ(d(1), 6);
+
+            IntDelegate copy(d);
+            EXPECT_EQ(Tracked::alive, 2);
+
+            IntDelegate moved(std::move(copy));
+            EXPECT_EQ(Tracked::alive, 2);
+            EXPECT_FALSE(copy);
+            EXPECT_EQ(moved(2), 7);
+
+            d = nullptr;
+            EXPECT_EQ(Tracked::alive, 1);
+        }
+
+        EXPECT_EQ(Tracked::alive, 0);
+    }
+
+
+    TEST(DelegateTest, heapFallback)
+    {
+        EXPECT_FALSE(IntDelegate::fitsInline<Large>());
+
+        Large large;
+        large.padding[0] = 3;
+
+        IntDelegate d(large);
+        EXPECT_FALSE(d.isTrivial());
+        EXPECT_EQ(d(1), 4);
+
+        IntDelegate copy(d);
+        d.reset();
+        EXPECT_EQ(copy(2), 5);
+
+        IntDelegate moved(std::move(copy));
+        EXPECT_EQ(moved(3), 6);
+    }
+
+
+    TEST(DelegateTest, largerStorage)
+    {
+        typedef Mif::Delegate<int(int), sizeof(Large)> BigDelegate;
+
+        EXPECT_TRUE(BigDelegate::fitsInline<Large>());
+
+        Large large;
+        large.padding[0] = 1;
+
+        BigDelegate d(large);
+        EXPECT_TRUE(d.isTrivial());
+        EXPECT_EQ(d(1), 2);
+    }
+
+
+    TEST(DelegateTest, referenceArguments)
+    {
+        Mif::Delegate<void(std::string&, const std::string&)> append(
+            [](std::string& dst, const std::string& src) { dst += src; });
+
+        std::string s = "foo";
+        append(s, "bar");
+        EXPECT_EQ(s, "foobar");
+    }
+
+
+    TEST(DelegateTest, rejectsNonCallables)
+    {
+        typedef Mif::Delegate<int(int)> IntDelegate;
+
+        EXPECT_FALSE((std::is_constructible<IntDelegate, int>::value));
+        EXPECT_FALSE((std::is_constructible<IntDelegate, void (*)(const char*)>::value));
+        EXPECT_TRUE((std::is_constructible<IntDelegate, int (*)(int)>::value));
+    }
+
+} // namespace anonymouse
@@ -0,0 +1,97 @@
+#include <cassert>
+#include <cinttypes>
+#include "dispatch_stats.h"
+
+namespace Mif {
+
+    DispatchStats::DispatchStats(uint32_t numObservers, uint32_t numEvents)
+    : m_numObservers(numObservers)
+    , m_numEvents(numEvents)
+    , m_observers(new Slot[numObservers])
+    , m_fanOut(new std::atomic<uint64_t>[numEvents * kNumFanOutBuckets])
+    , m_names(numObservers)
+    {
+        for (uint32_t i = 0; i < numObservers; i++)
+        {
+            m_names[i] = "observer" + std::to_string(i);
+        }
+
+        reset();
+    }
+
+
+    void DispatchStats::setObserverName(uint32_t observer, const char* name)
+    {
+        assert(observer < m_numObservers && "observer out of range");
+        m_names[observer] = name;
+    }
+
+
+    ObserverStats DispatchStats::observer(uint32_t observer) const
+    {
+        const Slot& slot = m_observers[observer];
+        const ObserverStats stats = {
+            slot.calls.load(std::memory_order_relaxed),
+            slot.totalCycles.load(std::memory_order_relaxed),
+            slot.maxCycles.load(std::memory_order_relaxed),
+        };
+
+        return stats;
+    }
+
+
+    uint64_t DispatchStats::fanOut(uint32_t event, uint32_t bucket) const
+    {
+        return m_fanOut[event * kNumFanOutBuckets + bucket].load(std::memory_order_relaxed);
+    }
+
+
+    void DispatchStats::dump(FILE* out) const
+    {
+        for (uint32_t i = 0; i < m_numObservers; i++)
+        {
+            const ObserverStats stats = observer(i);
+
+            if (stats.calls == 0)
+                continue;
+
+            const char* const name = m_names[i].c_str();
+            fprintf(out, "observer_calls{observer=\"%s\"} %" PRIu64 "\n", name, stats.calls);
+            fprintf(out, "observer_cycles_total{observer=\"%s\"} %" PRIu64 "\n", name, stats.totalCycles);
+            fprintf(out, "observer_cycles_max{observer=\"%s\"} %" PRIu64 "\n", name, stats.maxCycles);
+        }
+
+        for (uint32_t e = 0; e < m_numEvents; e++)
+        {
+            // cumulative buckets, as histograms are usually scraped
+            uint64_t cumulative = 0;
+
+            for (uint32_t b = 0; b < kNumFanOutBuckets; b++)
+            {
+                cumulative += fanOut(e, b);
+
+                if (b + 1 < kNumFanOutBuckets)
+                    fprintf(out, "event_fanout_bucket{event=\"%u\",le=\"%u\"} %" PRIu64 "\n", e, b == 0 ? 0 : (1u << b) - 1, cumulative);
+                else
+                    fprintf(out, "event_fanout_bucket{event=\"%u\",le=\"+Inf\"} %" PRIu64 "\n", e, cumulative);
+            }
+        }
+    }
+
+
+    void DispatchStats::reset()
+    {
+        for (uint32_t i = 0; i < m_numObservers; i++)
+        {
+            m_observers[i].calls.store(0, std::memory_order_relaxed);
+            m_observers[i].totalCycles.store(0, std::memory_order_relaxed);
+            m_observers[i].maxCycles.store(0, std::memory_order_relaxed);
+        }
+
+        for (uint32_t i = 0; i < m_numEvents * kNumFanOutBuckets; i++)
+        {
+            m_fanOut[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+} // namespace Mif
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Observer dispatch metrics.
+//
+// Subject only records into a DispatchStats when built with
+// MIF_DISPATCH_STATS=1; otherwise the hooks are preprocessed away and
+// dispatch costs exactly what it did before.
+
+#ifndef MIF_DISPATCH_STATS
+#define MIF_DISPATCH_STATS 0
+#endif
+
+namespace Mif {
+
+    struct ObserverStats {
+        uint64_t calls;
+        uint64_t totalCycles;
+        uint64_t maxCycles;
+    };
+
+    // Counters are relaxed atomics, each observer on its own cache line, so
+    // observers running on different pool threads do not contend.
+    class DispatchStats {
+    public:
+        // fan-out bucket b counts events delivered to [2^(b-1), 2^b) targets;
+        // bucket 0 counts events nobody received
+        static const uint32_t kNumFanOutBuckets = 8;
+
+        DispatchStats(uint32_t numObservers, uint32_t numEvents);
+
+        void setObserverName(uint32_t observer, const char* name);
+
+        void recordCall(uint32_t observer, uint64_t cycles)
+        {
+            Slot& slot = m_observers[observer];
+            slot.calls.fetch_add(1, std::memory_order_relaxed);
+            slot.totalCycles.fetch_add(cycles, std::memory_order_relaxed);
+
+            uint64_t max = slot.maxCycles.load(std::memory_order_relaxed);
+
+            while (cycles > max && !slot.maxCycles.compare_exchange_weak(max, cycles, std::memory_order_relaxed))
+            {
+                ;
+            }
+        }
+
+        // count events of one type, each delivered to fanOut targets
+        void recordFanOut(uint32_t event, uint32_t fanOut, uint32_t count = 1)
+        {
+            m_fanOut[event * kNumFanOutBuckets + fanOutBucket(fanOut)].fetch_add(count, std::memory_order_relaxed);
+        }
+
+        static uint32_t fanOutBucket(uint32_t fanOut)
+        {
+            const uint32_t bucket = fanOut == 0 ? 0 : 32 - __builtin_clz(fanOut);
+            return bucket < kNumFanOutBuckets ? bucket : kNumFanOutBuckets - 1;
+        }
+
+        ObserverStats observer(uint32_t observer) const;
+        uint64_t fanOut(uint32_t event, uint32_t bucket) const;
+
+        uint32_t numObservers() const { return m_numObservers; }
+        uint32_t numEvents() const { return m_numEvents; }
+
+        // Prometheus style text, one sample per line; observers that were
+        // never called are left out
+        void dump(FILE* out) const;
+
+        void reset();
+
+    private:
+        struct alignas(64) Slot {
+            std::atomic<uint64_t> calls;
+            std::atomic<uint64_t> totalCycles;
+            std::atomic<uint64_t> maxCycles;
+        };
+
+        const uint32_t m_numObservers;
+        const uint32_t m_numEvents;
+        std::unique_ptr<Slot[]> m_observers;
+        std::unique_ptr<std::atomic<uint64_t>[]> m_fanOut;  // event * kNumFanOutBuckets + bucket
+        std::vector<std::string> m_names;
+    };
+
+} // namespace Mif
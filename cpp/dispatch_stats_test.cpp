@@ -0,0 +1,106 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "dispatch_stats.h"
+#include "gtest/gtest.h"
+
+namespace { // for constants
+    const uint32_t kNumObservers = 4;
+    const uint32_t kNumEvents = 2;
+} // namespace anonymouse
+
+
+namespace { // for functions
+
+    TEST(DispatchStatsTest, observerCounters)
+    {
+        Mif::DispatchStats stats(kNumObservers, kNumEvents);
+
+        stats.recordCall(1, 100);
+        stats.recordCall(1, 300);
+        stats.recordCall(1, 200);
+
+        const Mif::ObserverStats s = stats.observer(1);
+        EXPECT_EQ(s.calls, 3);
+        EXPECT_EQ(s.totalCycles, 600);
+        EXPECT_EQ(s.maxCycles, 300);
+        EXPECT_EQ(stats.observer(0).calls, 0);
+
+        stats.reset();
+        EXPECT_EQ(stats.observer(1).calls, 0);
+        EXPECT_EQ(stats.observer(1).maxCycles, 0);
+    }
+
+
+    TEST(DispatchStatsTest, concurrentMax)
+    {
+        Mif::DispatchStats stats(kNumObservers, kNumEvents);
+        std::vector<std::thread> threads;
+
+        for (uint32_t t = 0; t < 4; t++)
+        {
+            threads.emplace_back([&stats, t]() {
+                for (uint64_t i = 0; i < 10000; i++)
+                {
+                    stats.recordCall(0, i * 4 + t);
+                }
+            });
+        }
+
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        EXPECT_EQ(stats.observer(0).calls, 40000);
+        EXPECT_EQ(stats.observer(0).maxCycles, 9999 * 4 + 3);
+    }
+
+
+    TEST(DispatchStatsTest, fanOutHistogram)
+    {
+        EXPECT_EQ(Mif::DispatchStats::fanOutBucket(0), 0);
+        EXPECT_EQ(Mif::DispatchStats::fanOutBucket(1), 1);
+        EXPECT_EQ(Mif::DispatchStats::fanOutBucket(3), 2);
+        EXPECT_EQ(Mif::DispatchStats::fanOutBucket(4), 3);
+        EXPECT_EQ(Mif::DispatchStats::fanOutBucket(100000), Mif::DispatchStats::kNumFanOutBuckets - 1);
+
+        Mif::DispatchStats stats(kNumObservers, kNumEvents);
+        stats.recordFanOut(1, 3, 5);
+        stats.recordFanOut(1, 2);
+        stats.recordFanOut(0, 0);
+
+        EXPECT_EQ(stats.fanOut(1, 2), 6);
+        EXPECT_EQ(stats.fanOut(0, 0), 1);
+        EXPECT_EQ(stats.fanOut(0, 2), 0);
+    }
+
+
+    TEST(DispatchStatsTest, dump)
+    {
+        Mif::DispatchStats stats(kNumObservers, kNumEvents);
+        stats.setObserverName(2, "achievement");
+        stats.recordCall(2, 42);
+        stats.recordFanOut(0, 2);
+
+        char* text = nullptr;
+        size_t size = 0;
+        FILE* const out = open_memstream(&text, &size);
+        ASSERT_NE(out, nullptr);
+        stats.dump(out);
+        fclose(out);
+
+        const std::string dump(text, size);
+        free(text);
+
+        EXPECT_NE(dump.find("observer_calls{observer=\"achievement\"} 1\n"), std::string::npos) << dump;
+        EXPECT_NE(dump.find("observer_cycles_max{observer=\"achievement\"} 42\n"), std::string::npos);
+        EXPECT_EQ(dump.find("observer0"), std::string::npos);  // never called
+        EXPECT_NE(dump.find("event_fanout_bucket{event=\"0\",le=\"1\"} 0\n"), std::string::npos);
+        EXPECT_NE(dump.find("event_fanout_bucket{event=\"0\",le=\"3\"} 1\n"), std::string::npos);
+        EXPECT_NE(dump.find("event_fanout_bucket{event=\"0\",le=\"+Inf\"} 1\n"), std::string::npos);
+    }
+
+} // namespace anonymouse
@@ -0,0 +1,288 @@
+#include <cassert>
+#include <cstring>
+#include "entity_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MIF_X86 1
+#include <immintrin.h>
+#endif
+
+// Each ISA level is compiled through the target attribute instead of
+// per-file compiler flags, so one translation unit holds all of them and
+// only the ones the CPU supports are ever called.
+
+namespace Mif {
+
+    namespace {
+
+        /***************************************************************/
+        // scalar, also used for the tails of the SIMD loops
+
+        void accelerateScalar(float* __restrict velY, uint32_t begin, uint32_t count, float dv)
+        {
+            for (uint32_t i = begin; i < count; i++)
+            {
+                velY[i] += dv;
+            }
+        }
+
+        void updateScalar(const EntityArrays& a, uint32_t begin, float dt)
+        {
+            float* __restrict px = a.posX;
+            float* __restrict py = a.posY;
+            const float* __restrict vx = a.velX;
+            float* __restrict vy = a.velY;
+            const float* __restrict fl = a.floor;
+            uint8_t* __restrict on = a.onSurface;
+
+            for (uint32_t i = begin; i < a.count; i++)
+            {
+                px[i] += vx[i] * dt;
+
+                const float y = py[i] + vy[i] * dt;
+                const bool landed = y <= fl[i];
+
+                py[i] = landed ? fl[i] : y;
+                vy[i] = (landed && vy[i] < 0.0f) ? 0.0f : vy[i];
+                on[i] = landed;
+            }
+        }
+
+        void accelerateScalarKernel(float* velY, uint32_t count, float dv)
+        {
+            accelerateScalar(velY, 0, count, dv);
+        }
+
+        void updateScalarKernel(const EntityArrays& a, float dt)
+        {
+            updateScalar(a, 0, dt);
+        }
+
+#if MIF_X86
+        /***************************************************************/
+        // compare masks come out as bits; expand them to 0/1 bytes with a table
+
+        struct ByteLut {
+            uint64_t bytes[256];
+        };
+
+        constexpr ByteLut makeByteLut()
+        {
+            ByteLut lut = {};
+
+            for (uint32_t mask = 0; mask < 256; mask++)
+            {
+                for (uint32_t bit = 0; bit < 8; bit++)
+                {
+                    if (mask & (1u << bit))
+                        lut.bytes[mask] |= 1ull << (8 * bit);
+                }
+            }
+
+            return lut;
+        }
+
+        constexpr ByteLut kByteLut = makeByteLut();
+
+        inline void storeMaskBytes(uint8_t* dst, uint32_t mask, size_t n)
+        {
+            // x86 is little endian, so the low bytes hold the low bits
+            std::memcpy(dst, &kByteLut.bytes[mask & 0xff], n);
+        }
+
+        /***************************************************************/
+
+        __attribute__((target("sse2")))
+        void accelerateSse2(float* velY, uint32_t count, float dv)
+        {
+            const __m128 d = _mm_set1_ps(dv);
+            uint32_t i = 0;
+
+            for (; i + 4 <= count; i += 4)
+            {
+                _mm_storeu_ps(velY + i, _mm_add_ps(_mm_loadu_ps(velY + i), d));
+            }
+
+            accelerateScalar(velY, i, count, dv);
+        }
+
+        __attribute__((target("sse2")))
+        void updateSse2(const EntityArrays& a, float dt)
+        {
+            const __m128 t = _mm_set1_ps(dt);
+            const __m128 zero = _mm_setzero_ps();
+            uint32_t i = 0;
+
+            for (; i + 4 <= a.count; i += 4)
+            {
+                const __m128 px = _mm_add_ps(_mm_loadu_ps(a.posX + i), _mm_mul_ps(_mm_loadu_ps(a.velX + i), t));
+                _mm_storeu_ps(a.posX + i, px);
+
+                const __m128 vy = _mm_loadu_ps(a.velY + i);
+                const __m128 fl = _mm_loadu_ps(a.floor + i);
+                const __m128 y = _mm_add_ps(_mm_loadu_ps(a.posY + i), _mm_mul_ps(vy, t));
+                const __m128 landed = _mm_cmple_ps(y, fl);
+                const __m128 stop = _mm_and_ps(landed, _mm_cmplt_ps(vy, zero));
+
+                _mm_storeu_ps(a.posY + i, _mm_or_ps(_mm_and_ps(landed, fl), _mm_andnot_ps(landed, y)));
+                _mm_storeu_ps(a.velY + i, _mm_andnot_ps(stop, vy));
+                storeMaskBytes(a.onSurface + i, _mm_movemask_ps(landed), 4);
+            }
+
+            updateScalar(a, i, dt);
+        }
+
+        /***************************************************************/
+
+        __attribute__((target("avx2")))
+        void accelerateAvx2(float* velY, uint32_t count, float dv)
+        {
+            const __m256 d = _mm256_set1_ps(dv);
+            uint32_t i = 0;
+
+            for (; i + 8 <= count; i += 8)
+            {
+                _mm256_storeu_ps(velY + i, _mm256_add_ps(_mm256_loadu_ps(velY + i), d));
+            }
+
+            accelerateScalar(velY, i, count, dv);
+        }
+
+        __attribute__((target("avx2")))
+        void updateAvx2(const EntityArrays& a, float dt)
+        {
+            const __m256 t = _mm256_set1_ps(dt);
+            const __m256 zero = _mm256_setzero_ps();
+            uint32_t i = 0;
+
+            for (; i + 8 <= a.count; i += 8)
+            {
+                const __m256 px = _mm256_add_ps(_mm256_loadu_ps(a.posX + i), _mm256_mul_ps(_mm256_loadu_ps(a.velX + i), t));
+                _mm256_storeu_ps(a.posX + i, px);
+
+                const __m256 vy = _mm256_loadu_ps(a.velY + i);
+                const __m256 fl = _mm256_loadu_ps(a.floor + i);
+                const __m256 y = _mm256_add_ps(_mm256_loadu_ps(a.posY + i), _mm256_mul_ps(vy, t));
+                const __m256 landed = _mm256_cmp_ps(y, fl, _CMP_LE_OQ);
+                const __m256 stop = _mm256_and_ps(landed, _mm256_cmp_ps(vy, zero, _CMP_LT_OQ));
+
+                _mm256_storeu_ps(a.posY + i, _mm256_blendv_ps(y, fl, landed));
+                _mm256_storeu_ps(a.velY + i, _mm256_andnot_ps(stop, vy));
+                storeMaskBytes(a.onSurface + i, _mm256_movemask_ps(landed), 8);
+            }
+
+            updateScalar(a, i, dt);
+        }
+
+        /***************************************************************/
+
+        __attribute__((target("avx512f")))
+        void accelerateAvx512(float* velY, uint32_t count, float dv)
+        {
+            const __m512 d = _mm512_set1_ps(dv);
+            uint32_t i = 0;
+
+            for (; i + 16 <= count; i += 16)
+            {
+                _mm512_storeu_ps(velY + i, _mm512_add_ps(_mm512_loadu_ps(velY + i), d));
+            }
+
+            accelerateScalar(velY, i, count, dv);
+        }
+
+        __attribute__((target("avx512f")))
+        void updateAvx512(const EntityArrays& a, float dt)
+        {
+            const __m512 t = _mm512_set1_ps(dt);
+            const __m512 zero = _mm512_setzero_ps();
+            uint32_t i = 0;
+
+            for (; i + 16 <= a.count; i += 16)
+            {
+                const __m512 px = _mm512_add_ps(_mm512_loadu_ps(a.posX + i), _mm512_mul_ps(_mm512_loadu_ps(a.velX + i), t));
+                _mm512_storeu_ps(a.posX + i, px);
+
+                const __m512 vy = _mm512_loadu_ps(a.velY + i);
+                const __m512 fl = _mm512_loadu_ps(a.floor + i);
+                const __m512 y = _mm512_add_ps(_mm512_loadu_ps(a.posY + i), _mm512_mul_ps(vy, t));
+                const __mmask16 landed = _mm512_cmp_ps_mask(y, fl, _CMP_LE_OQ);
+                const __mmask16 stop = _mm512_mask_cmp_ps_mask(landed, vy, zero, _CMP_LT_OQ);
+
+                _mm512_storeu_ps(a.posY + i, _mm512_mask_blend_ps(landed, y, fl));
+                _mm512_storeu_ps(a.velY + i, _mm512_mask_mov_ps(vy, stop, zero));
+                storeMaskBytes(a.onSurface + i, landed, 8);
+                storeMaskBytes(a.onSurface + i + 8, landed >> 8, 8);
+            }
+
+            updateScalar(a, i, dt);
+        }
+#endif // MIF_X86
+
+        const EntityKernels kKernels[] = {
+            { Isa::SCALAR, accelerateScalarKernel, updateScalarKernel },
+#if MIF_X86
+            { Isa::SSE2, accelerateSse2, updateSse2 },
+            { Isa::AVX2, accelerateAvx2, updateAvx2 },
+            { Isa::AVX512, accelerateAvx512, updateAvx512 },
+#endif
+        };
+
+    } // namespace anonymouse
+
+
+    const char* isaName(Isa isa)
+    {
+        switch (isa)
+        {
+        case Isa::SCALAR: return "scalar";
+        case Isa::SSE2: return "sse2";
+        case Isa::AVX2: return "avx2";
+        case Isa::AVX512: return "avx512";
+        default: return "unknown";
+        }
+    }
+
+
+    bool isaSupported(Isa isa)
+    {
+        switch (isa)
+        {
+        case Isa::SCALAR:
+            return true;
+#if MIF_X86
+        case Isa::SSE2:
+            return __builtin_cpu_supports("sse2");
+        case Isa::AVX2:
+            return __builtin_cpu_supports("avx2");
+        case Isa::AVX512:
+            return __builtin_cpu_supports("avx512f");
+#endif
+        default:
+            return false;
+        }
+    }
+
+
+    Isa detectIsa()
+    {
+        static const Isa isa = []() {
+            for (int i = static_cast<int>(Isa::NUM) - 1; i > 0; i--)
+            {
+                if (isaSupported(static_cast<Isa>(i)))
+                    return static_cast<Isa>(i);
+            }
+            return Isa::SCALAR;
+        }();
+
+        return isa;
+    }
+
+
+    const EntityKernels& getEntityKernels(Isa isa)
+    {
+        assert(isaSupported(isa) && "isa is not supported on this cpu");
+
+        return kKernels[static_cast<int>(isa)];
+    }
+
+} // namespace Mif
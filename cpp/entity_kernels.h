@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Mif {
+
+    enum class Isa {
+        SCALAR = 0,
+        SSE2,
+        AVX2,
+        AVX512,
+        NUM
+    };
+
+    // views of the EntityStore arrays a kernel works on
+    struct EntityArrays {
+        float* posX;
+        float* posY;
+        const float* velX;
+        float* velY;
+        const float* floor;
+        uint8_t* onSurface;
+        uint32_t count;
+    };
+
+    typedef void (*AccelerateKernel)(float* velY, uint32_t count, float dv);
+    typedef void (*UpdateKernel)(const EntityArrays& arrays, float dt);
+
+    struct EntityKernels {
+        Isa isa;
+        AccelerateKernel accelerate;  // velY += dv
+        UpdateKernel update;          // integrate position and clamp to floor
+    };
+
+    const char* isaName(Isa isa);
+
+    // whether this build and the running CPU can execute kernels for isa
+    bool isaSupported(Isa isa);
+
+    // widest isa supported by the running CPU, detected once
+    Isa detectIsa();
+
+    const EntityKernels& getEntityKernels(Isa isa);
+
+    inline const EntityKernels& getEntityKernels()
+    {
+        return getEntityKernels(detectIsa());
+    }
+
+} // namespace Mif
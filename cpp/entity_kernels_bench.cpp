@@ -0,0 +1,71 @@
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include "entity_store.h"
+
+using namespace std;
+
+// Entities per second of accelerateAll() + updateAll() for each ISA level
+// the CPU supports, all running over the same initial dataset.
+
+#define VPRINTF(...) \
+    do { \
+        printf(__VA_ARGS__); \
+    } while (false)
+
+namespace {
+
+    const uint32_t kNumEntities = 1 << 20;
+    const int kNumTicks = 200;
+    const float kTimeStep = 1.0f / 60.0f;
+    const float kGravity = -10.0f;
+
+    void fill(Mif::EntityStore& store)
+    {
+        srand(0);
+
+        for (uint32_t i = 0; i < kNumEntities; i++)
+        {
+            const Mif::EntityId id = store.create(rand() % 1000, rand() % 100);
+            store.velY()[store.indexOf(id)] = (rand() % 200) - 100.0f;
+        }
+    }
+
+} // namespace anonymouse
+
+
+int main()
+{
+    VPRINTF("%u entities, %d ticks\n", kNumEntities, kNumTicks);
+    VPRINTF("%-8s %16s %14s\n", "isa", "entities/s", "ns/entity");
+
+    for (int i = 0; i < static_cast<int>(Mif::Isa::NUM); i++)
+    {
+        const Mif::Isa isa = static_cast<Mif::Isa>(i);
+
+        if (!Mif::isaSupported(isa))
+        {
+            VPRINTF("%-8s %16s\n", Mif::isaName(isa), "unsupported");
+            continue;
+        }
+
+        Mif::EntityStore store(kNumEntities);
+        store.setIsa(isa);
+        fill(store);
+
+        const auto start = chrono::steady_clock::now();
+
+        for (int tick = 0; tick < kNumTicks; tick++)
+        {
+            store.accelerateAll(kGravity, kTimeStep);
+            store.updateAll(kTimeStep);
+        }
+
+        const chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        const double entities = static_cast<double>(kNumEntities) * kNumTicks;
+
+        VPRINTF("%-8s %16.0f %14.3f\n", Mif::isaName(isa), entities / elapsed.count(), elapsed.count() * 1e9 / entities);
+    }
+
+    return 0;
+}
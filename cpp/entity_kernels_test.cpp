@@ -0,0 +1,127 @@
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "entity_kernels.h"
+#include "gtest/gtest.h"
+
+namespace { // for constants
+    const uint32_t kNumEntities = 1000 + 13; // not a multiple of any vector width
+    const float kTimeStep = 1.0f / 60.0f;
+
+    float randomFloat(float lo, float hi)
+    {
+        return lo + (hi - lo) * (rand() / (float)RAND_MAX);
+    }
+
+    struct Arrays
+    {
+        std::vector<float> posX, posY, velX, velY, floor;
+        std::vector<uint8_t> onSurface;
+
+        Mif::EntityArrays view()
+        {
+            Mif::EntityArrays a = {
+                posX.data(), posY.data(), velX.data(), velY.data(),
+                floor.data(), onSurface.data(), static_cast<uint32_t>(posX.size())
+            };
+            return a;
+        }
+    };
+
+    Arrays makeArrays(uint32_t n)
+    {
+        Arrays a;
+
+        for (uint32_t i = 0; i < n; i++)
+        {
+            a.posX.push_back(randomFloat(-100.0f, 100.0f));
+            a.posY.push_back(randomFloat(0.0f, 1.0f));
+            a.velX.push_back(randomFloat(-10.0f, 10.0f));
+            a.velY.push_back(randomFloat(-30.0f, 30.0f));
+            a.floor.push_back(randomFloat(0.0f, 0.5f));
+            a.onSurface.push_back(0);
+        }
+
+        return a;
+    }
+} // namespace anonymouse
+
+
+namespace { // for functions
+
+    TEST(EntityKernelsTest, scalarAlwaysSupported)
+    {
+        EXPECT_TRUE(Mif::isaSupported(Mif::Isa::SCALAR));
+        EXPECT_TRUE(Mif::isaSupported(Mif::detectIsa()));
+        EXPECT_EQ(Mif::getEntityKernels().isa, Mif::detectIsa());
+        EXPECT_STREQ(Mif::isaName(Mif::Isa::AVX2), "avx2");
+    }
+
+
+    TEST(EntityKernelsTest, matchScalar)
+    {
+        const Arrays initial = makeArrays(kNumEntities);
+
+        Arrays expected = initial;
+        const Mif::EntityKernels& scalar = Mif::getEntityKernels(Mif::Isa::SCALAR);
+
+        for (int tick = 0; tick < 10; tick++)
+        {
+            scalar.accelerate(expected.velY.data(), kNumEntities, -10.0f * kTimeStep);
+            scalar.update(expected.view(), kTimeStep);
+        }
+
+        for (int i = 1; i < static_cast<int>(Mif::Isa::NUM); i++)
+        {
+            const Mif::Isa isa = static_cast<Mif::Isa>(i);
+
+            if (!Mif::isaSupported(isa))
+            {
+                printf("%s not supported, skipped\n", Mif::isaName(isa));
+                continue;
+            }
+
+            Arrays actual = initial;
+            const Mif::EntityKernels& kernels = Mif::getEntityKernels(isa);
+            EXPECT_EQ(kernels.isa, isa);
+
+            for (int tick = 0; tick < 10; tick++)
+            {
+                kernels.accelerate(actual.velY.data(), kNumEntities, -10.0f * kTimeStep);
+                kernels.update(actual.view(), kTimeStep);
+            }
+
+            for (uint32_t j = 0; j < kNumEntities; j++)
+            {
+                EXPECT_NEAR(actual.posX[j], expected.posX[j], 1e-4f) << Mif::isaName(isa) << " " << j;
+                EXPECT_NEAR(actual.posY[j], expected.posY[j], 1e-4f) << Mif::isaName(isa) << " " << j;
+                EXPECT_NEAR(actual.velY[j], expected.velY[j], 1e-4f) << Mif::isaName(isa) << " " << j;
+                EXPECT_EQ(actual.onSurface[j], expected.onSurface[j]) << Mif::isaName(isa) << " " << j;
+            }
+        }
+    }
+
+
+    TEST(EntityKernelsTest, landing)
+    {
+        // every lane lands, so all the mask bytes must be written
+        Arrays a = makeArrays(64);
+
+        for (uint32_t i = 0; i < 64; i++)
+        {
+            a.posY[i] = 0.0f;
+            a.velY[i] = -1.0f;
+            a.floor[i] = 0.0f;
+        }
+
+        Mif::getEntityKernels().update(a.view(), kTimeStep);
+
+        for (uint32_t i = 0; i < 64; i++)
+        {
+            EXPECT_EQ(a.onSurface[i], 1);
+            EXPECT_EQ(a.posY[i], 0.0f);
+            EXPECT_EQ(a.velY[i], 0.0f);
+        }
+    }
+
+} // namespace anonymouse
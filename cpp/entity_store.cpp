@@ -0,0 +1,83 @@
+#include <cassert>
+#include "entity_store.h"
+
+namespace Mif {
+
+    EntityStore::EntityStore(uint32_t reserve)
+    : m_kernels(&getEntityKernels())
+    {
+        m_posX.reserve(reserve);
+        m_posY.reserve(reserve);
+        m_velX.reserve(reserve);
+        m_velY.reserve(reserve);
+        m_floor.reserve(reserve);
+        m_onSurface.reserve(reserve);
+        m_handles.reserve(reserve);
+    }
+
+
+    EntityId EntityStore::create(float x, float y)
+    {
+        m_posX.push_back(x);
+        m_posY.push_back(y);
+        m_velX.push_back(0.0f);
+        m_velY.push_back(0.0f);
+        m_floor.push_back(0.0f);
+        m_onSurface.push_back(y <= 0.0f);
+
+        return m_handles.create();
+    }
+
+
+    void EntityStore::destroy(EntityId id)
+    {
+        const uint32_t last = size() - 1;
+        const uint32_t index = m_handles.destroy(id);
+
+        // move the last entity into the hole to keep the arrays packed
+        if (index != last)
+        {
+            m_posX[index] = m_posX[last];
+            m_posY[index] = m_posY[last];
+            m_velX[index] = m_velX[last];
+            m_velY[index] = m_velY[last];
+            m_floor[index] = m_floor[last];
+            m_onSurface[index] = m_onSurface[last];
+        }
+
+        m_posX.pop_back();
+        m_posY.pop_back();
+        m_velX.pop_back();
+        m_velY.pop_back();
+        m_floor.pop_back();
+        m_onSurface.pop_back();
+    }
+
+
+    void EntityStore::accelerateAll(float a, float dt)
+    {
+        m_kernels->accelerate(m_velY.data(), size(), a * dt);
+    }
+
+
+    void EntityStore::updateAll(float dt)
+    {
+        m_kernels->update(arrays(), dt);
+    }
+
+
+    EntityArrays EntityStore::arrays()
+    {
+        EntityArrays a;
+        a.posX = m_posX.data();
+        a.posY = m_posY.data();
+        a.velX = m_velX.data();
+        a.velY = m_velY.data();
+        a.floor = m_floor.data();
+        a.onSurface = m_onSurface.data();
+        a.count = size();
+
+        return a;
+    }
+
+} // namespace Mif
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "memory_allocator.h"
+#include "entity_kernels.h"
+#include "slot_map.h"
+
+// reference: http://gameprogrammingpatterns.com/data-locality.html
+
+namespace Mif {
+
+    typedef Handle EntityId;
+
+    typedef std::vector<float, AlignedAllocator<float>> FloatArray;
+    typedef std::vector<uint8_t, AlignedAllocator<uint8_t>> ByteArray;
+
+    // Entity state in structure-of-arrays form.
+    // Live entities are packed in [0, size()) of every array, so the batched
+    // kernels stream over contiguous memory. An EntityId is a generational
+    // handle: it stays valid while the entity is alive even though its dense
+    // index changes when other entities are destroyed (swap-remove), and it
+    // is detected as stale once the entity is gone.
+    class EntityStore {
+    public:
+        explicit EntityStore(uint32_t reserve = 0);
+
+        EntityId create(float x, float y);
+        void destroy(EntityId id);
+
+        bool alive(EntityId id) const { return m_handles.valid(id); }
+        uint32_t indexOf(EntityId id) const { return m_handles.indexOf(id); }
+        EntityId idAt(uint32_t index) const { return m_handles.handleAt(index); }
+        uint32_t size() const { return m_handles.size(); }
+
+        // vel.y += a * dt for every entity
+        void accelerateAll(float a, float dt);
+
+        // pos += vel * dt, then clamp to the floor height:
+        // an entity at or below its floor stands on it and stops falling
+        void updateAll(float dt);
+
+        // kernels default to the widest ISA the CPU supports
+        void setIsa(Isa isa) { m_kernels = &getEntityKernels(isa); }
+        Isa isa() const { return m_kernels->isa; }
+
+        EntityArrays arrays();
+
+        // dense arrays, indexed by indexOf(id)
+        float* posX() { return m_posX.data(); }
+        float* posY() { return m_posY.data(); }
+        float* velX() { return m_velX.data(); }
+        float* velY() { return m_velY.data(); }
+        float* floor() { return m_floor.data(); }
+        uint8_t* onSurface() { return m_onSurface.data(); }
+
+        const float* posX() const { return m_posX.data(); }
+        const float* posY() const { return m_posY.data(); }
+        const float* velX() const { return m_velX.data(); }
+        const float* velY() const { return m_velY.data(); }
+        const float* floor() const { return m_floor.data(); }
+        const uint8_t* onSurface() const { return m_onSurface.data(); }
+
+    private:
+        FloatArray m_posX;
+        FloatArray m_posY;
+        FloatArray m_velX;
+        FloatArray m_velY;
+        FloatArray m_floor;     // height of the surface below the entity
+        ByteArray m_onSurface;  // 1 when the entity stands on its floor
+
+        HandleTable m_handles;
+
+        const EntityKernels* m_kernels;
+    };
+
+} // namespace Mif
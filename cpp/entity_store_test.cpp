@@ -0,0 +1,124 @@
+#include <cstdio>
+#include <cstdint>
+#include "entity_store.h"
+#include "gtest/gtest.h"
+
+namespace { // for constants
+    const float kTimeStep = 0.5f;
+    const uint32_t kNumEntities = 1000;
+} // namespace anonymouse
+
+namespace { // for test fixture
+    class EntityStoreTest : public ::testing::Test
+    {
+    public:
+        void SetUp();
+        void TearDown();
+
+        Mif::EntityStore* store_;
+    };
+
+    void EntityStoreTest::SetUp()
+    {
+        store_ = new Mif::EntityStore(kNumEntities);
+    }
+
+    void EntityStoreTest::TearDown()
+    {
+        delete(store_);
+    }
+} // namespace anonymouse
+
+
+namespace { // for functions
+
+    TEST_F(EntityStoreTest, createDestroy)
+    {
+        const Mif::EntityId a = store_->create(1.0f, 10.0f);
+        const Mif::EntityId b = store_->create(2.0f, 20.0f);
+        const Mif::EntityId c = store_->create(3.0f, 30.0f);
+
+        EXPECT_EQ(store_->size(), 3);
+        EXPECT_TRUE(store_->alive(a));
+        EXPECT_FALSE(store_->alive(Mif::EntityId()));
+
+        store_->destroy(a);
+
+        EXPECT_EQ(store_->size(), 2);
+        EXPECT_FALSE(store_->alive(a));
+
+        // ids stay valid although c was moved into a's dense slot
+        EXPECT_FLOAT_EQ(store_->posY()[store_->indexOf(b)], 20.0f);
+        EXPECT_FLOAT_EQ(store_->posY()[store_->indexOf(c)], 30.0f);
+        EXPECT_EQ(store_->idAt(store_->indexOf(c)), c);
+
+        // freed slot is reused with a new generation
+        const Mif::EntityId d = store_->create(4.0f, 40.0f);
+        EXPECT_EQ(d.index(), a.index());
+        EXPECT_NE(d, a);
+        EXPECT_FALSE(store_->alive(a));
+        EXPECT_FLOAT_EQ(store_->posX()[store_->indexOf(d)], 4.0f);
+    }
+
+
+    TEST_F(EntityStoreTest, alignment)
+    {
+        for (uint32_t i = 0; i < kNumEntities; i++)
+        {
+            store_->create(0.0f, 1.0f);
+        }
+
+        EXPECT_EQ((uintptr_t)store_->posX() % 64, 0);
+        EXPECT_EQ((uintptr_t)store_->posY() % 64, 0);
+        EXPECT_EQ((uintptr_t)store_->velY() % 64, 0);
+        EXPECT_EQ((uintptr_t)store_->onSurface() % 64, 0);
+    }
+
+
+    TEST_F(EntityStoreTest, fallAndLand)
+    {
+        const Mif::EntityId id = store_->create(0.0f, 1.0f);
+        const uint32_t i = store_->indexOf(id);
+
+        store_->velX()[i] = 2.0f;
+        store_->accelerateAll(-2.0f, kTimeStep);
+
+        EXPECT_FLOAT_EQ(store_->velY()[i], -1.0f);
+
+        store_->updateAll(kTimeStep);
+
+        EXPECT_FLOAT_EQ(store_->posX()[i], 1.0f);
+        EXPECT_FLOAT_EQ(store_->posY()[i], 0.5f);
+        EXPECT_EQ(store_->onSurface()[i], 0);
+
+        store_->accelerateAll(-2.0f, kTimeStep);
+        store_->updateAll(kTimeStep);
+
+        // clamped to the floor and stopped
+        EXPECT_FLOAT_EQ(store_->posY()[i], 0.0f);
+        EXPECT_FLOAT_EQ(store_->velY()[i], 0.0f);
+        EXPECT_EQ(store_->onSurface()[i], 1);
+
+        // can jump off again
+        store_->velY()[i] = 4.0f;
+        store_->updateAll(kTimeStep);
+
+        EXPECT_FLOAT_EQ(store_->posY()[i], 2.0f);
+        EXPECT_EQ(store_->onSurface()[i], 0);
+    }
+
+
+    TEST_F(EntityStoreTest, floorHeight)
+    {
+        const Mif::EntityId id = store_->create(0.0f, 10.0f);
+        const uint32_t i = store_->indexOf(id);
+
+        store_->floor()[i] = 9.0f;
+        store_->velY()[i] = -4.0f;
+        store_->updateAll(kTimeStep);
+
+        EXPECT_FLOAT_EQ(store_->posY()[i], 9.0f);
+        EXPECT_EQ(store_->onSurface()[i], 1);
+    }
+
+} // namespace anonymouse
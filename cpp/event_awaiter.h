@@ -0,0 +1,289 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdlib>
+#include <coroutine>
+#include <exception>
+#include <new>
+#include <utility>
+#include "memory_allocator.h"
+
+// C++20 coroutines waiting for events:
+//
+//     Mif::Script watch(Subject& subject)
+//     {
+//         for (;;)
+//         {
+//             const EntityHandle entity = co_await subject.next(EVENT_ENTITY_FELL);
+//             ...
+//         }
+//     }
+//
+// A Script runs eagerly up to its first co_await. Scripts started while a
+// ScriptFrames scope is alive take their coroutine frame from its pool
+// instead of the heap; the frame goes back to that pool when it ends.
+
+namespace Mif {
+
+    class ScriptFrames {
+    public:
+        explicit ScriptFrames(PoolAllocator& pool)
+        : m_previous(t_current)
+        {
+            t_current = &pool;
+        }
+
+        ~ScriptFrames() { t_current = m_previous; }
+
+        ScriptFrames(const ScriptFrames&) = delete;
+        ScriptFrames& operator=(const ScriptFrames&) = delete;
+
+        static PoolAllocator* current() { return t_current; }
+
+    private:
+        static inline thread_local PoolAllocator* t_current = nullptr;
+
+        PoolAllocator* const m_previous;
+    };
+
+
+    class Script {
+    public:
+        struct promise_type {
+            Script get_return_object() { return Script(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+
+            // frames are prefixed with the pool they came from, nullptr for the heap
+            static void* operator new(size_t size)
+            {
+                PoolAllocator* const pool = ScriptFrames::current();
+
+                if (pool && size + kHeaderSize <= pool->getBlockSize())
+                    return withHeader(pool->alloc(), pool);
+
+                void* const block = std::malloc(size + kHeaderSize);
+
+                if (block == nullptr)
+                    throw std::bad_alloc();
+
+                return withHeader(block, nullptr);
+            }
+
+            static void operator delete(void* frame, size_t)
+            {
+                void* const block = static_cast<char*>(frame) - kHeaderSize;
+                PoolAllocator* const pool = *static_cast<PoolAllocator**>(block);
+
+                if (pool)
+                    pool->free(block);
+                else
+                    std::free(block);
+            }
+
+        private:
+            // keeps the frame at the default new alignment
+            static const size_t kHeaderSize = 16;
+
+            static void* withHeader(void* block, PoolAllocator* pool)
+            {
+                *static_cast<PoolAllocator**>(block) = pool;
+                return static_cast<char*>(block) + kHeaderSize;
+            }
+        };
+
+        Script() {}
+        Script(Script&& other) : m_handle(std::exchange(other.m_handle, nullptr)) {}
+
+        Script& operator=(Script&& other)
+        {
+            if (this != &other)
+            {
+                destroy();
+                m_handle = std::exchange(other.m_handle, nullptr);
+            }
+
+            return *this;
+        }
+
+        // a script still waiting for an event is cancelled
+        ~Script() { destroy(); }
+
+        bool done() const { return !m_handle || m_handle.done(); }
+
+    private:
+        explicit Script(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+
+        void destroy()
+        {
+            if (m_handle)
+                m_handle.destroy();
+
+            m_handle = nullptr;
+        }
+
+        std::coroutine_handle<promise_type> m_handle;
+    };
+
+
+    // Coroutines suspended until an event of a given type is notified.
+    // Waiters are intrusive nodes living in the suspended frames, so waiting
+    // allocates nothing; a destroyed frame unlinks its waiter.
+    // EventAwaiters may go away before the scripts waiting on it: they are
+    // detached and never resumed, and are then only safe to destroy.
+    template<typename Entity, typename Event, size_t kNumEvents>
+    class EventAwaiters {
+    private:
+        struct List;
+
+    public:
+        class Awaiter {
+        public:
+            Awaiter(EventAwaiters& owner, Event event)
+            : m_owner(owner)
+            , m_event(event)
+            , m_list(nullptr)
+            , m_prev(nullptr)
+            , m_next(nullptr)
+            , m_entity()
+            {
+                ;
+            }
+
+            Awaiter(const Awaiter&) = delete;
+            Awaiter& operator=(const Awaiter&) = delete;
+
+            ~Awaiter()
+            {
+                if (m_list)
+                    m_list->remove(this);
+            }
+
+            bool await_ready() const { return false; }
+
+            void await_suspend(std::coroutine_handle<> handle)
+            {
+                m_handle = handle;
+                m_owner.m_waiting[static_cast<size_t>(m_event)].pushBack(this);
+            }
+
+            Entity await_resume() const { return m_entity; }
+
+        private:
+            friend class EventAwaiters;
+
+            EventAwaiters& m_owner;
+            const Event m_event;
+            List* m_list;
+            Awaiter* m_prev;
+            Awaiter* m_next;
+            Entity m_entity;
+            std::coroutine_handle<> m_handle;
+        };
+
+        EventAwaiters() {}
+
+        // pending awaiters must not unlink themselves from freed lists later
+        ~EventAwaiters()
+        {
+            for (List& list : m_waiting)
+            {
+                list.detachAll();
+            }
+        }
+
+        EventAwaiters(const EventAwaiters&) = delete;
+        EventAwaiters& operator=(const EventAwaiters&) = delete;
+
+        Awaiter next(Event event)
+        {
+            assert(static_cast<size_t>(event) < kNumEvents && "event out of range");
+            return Awaiter(*this, event);
+        }
+
+        // Resumes every coroutine waiting for event, in the order they started
+        // waiting. A coroutine that awaits the same event again waits for the
+        // next resume(). Returns the number of coroutines resumed.
+        uint32_t resume(const Entity& entity, Event event)
+        {
+            List ready;
+            ready.splice(m_waiting[static_cast<size_t>(event)]);
+
+            uint32_t count = 0;
+
+            while (Awaiter* const awaiter = ready.popFront())
+            {
+                awaiter->m_entity = entity;
+                awaiter->m_handle.resume();
+                count++;
+            }
+
+            return count;
+        }
+
+        uint32_t numWaiting(Event event) const { return m_waiting[static_cast<size_t>(event)].size; }
+
+    private:
+        struct List {
+            Awaiter* head = nullptr;
+            Awaiter* tail = nullptr;
+            uint32_t size = 0;
+
+            void pushBack(Awaiter* a)
+            {
+                a->m_list = this;
+                a->m_prev = tail;
+                a->m_next = nullptr;
+                (tail ? tail->m_next : head) = a;
+                tail = a;
+                size++;
+            }
+
+            void remove(Awaiter* a)
+            {
+                (a->m_prev ? a->m_prev->m_next : head) = a->m_next;
+                (a->m_next ? a->m_next->m_prev : tail) = a->m_prev;
+                a->m_list = nullptr;
+                size--;
+            }
+
+            Awaiter* popFront()
+            {
+                Awaiter* const a = head;
+
+                if (a)
+                    remove(a);
+
+                return a;
+            }
+
+            void detachAll()
+            {
+                while (Awaiter* const a = popFront())
+                {
+                    a->m_prev = a->m_next = nullptr;
+                }
+            }
+
+            void splice(List& other)
+            {
+                for (Awaiter* a = other.head; a; a = a->m_next)
+                {
+                    a->m_list = this;
+                }
+
+                head = other.head;
+                tail = other.tail;
+                size = other.size;
+                other.head = other.tail = nullptr;
+                other.size = 0;
+            }
+        };
+
+        List m_waiting[kNumEvents];
+    };
+
+} // namespace Mif
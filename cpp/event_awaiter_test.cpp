@@ -0,0 +1,142 @@
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <vector>
+#include "event_awaiter.h"
+#include "gtest/gtest.h"
+
+namespace { // for constants
+    enum TestEvent {
+        EVENT_FELL = 0,
+        EVENT_JUMPED,
+        EVENT_NUM
+    };
+
+    const uint32_t kNumScripts = 1000;
+} // namespace anonymouse
+
+namespace { // for types
+    typedef Mif::EventAwaiters<int, TestEvent, EVENT_NUM> Awaiters;
+
+    Mif::Script countFalls(Awaiters& awaiters, int numFalls, std::vector<int>& seen)
+    {
+        for (int i = 0; i < numFalls; i++)
+        {
+            seen.push_back(co_await awaiters.next(EVENT_FELL));
+        }
+    }
+
+    Mif::Script jumpThenFall(Awaiters& awaiters, std::vector<int>& seen)
+    {
+        seen.push_back(co_await awaiters.next(EVENT_JUMPED));
+        seen.push_back(co_await awaiters.next(EVENT_FELL));
+    }
+} // namespace anonymouse
+
+
+namespace { // for functions
+
+    TEST(EventAwaiterTest, resumesInOrder)
+    {
+        Awaiters awaiters;
+        std::vector<int> seen;
+
+        Mif::Script script = countFalls(awaiters, 2, seen);
+        EXPECT_FALSE(script.done());
+        EXPECT_EQ(awaiters.numWaiting(EVENT_FELL), 1);
+
+        EXPECT_EQ(awaiters.resume(10, EVENT_JUMPED), 0);
+        EXPECT_EQ(awaiters.resume(11, EVENT_FELL), 1);
+        EXPECT_FALSE(script.done());
+
+        // waits again for the next notification, not the current one
+        EXPECT_EQ(awaiters.numWaiting(EVENT_FELL), 1);
+        EXPECT_EQ(awaiters.resume(12, EVENT_FELL), 1);
+        EXPECT_TRUE(script.done());
+
+        EXPECT_EQ(seen, std::vector<int>({ 11, 12 }));
+        EXPECT_EQ(awaiters.numWaiting(EVENT_FELL), 0);
+    }
+
+
+    TEST(EventAwaiterTest, framesComeFromPool)
+    {
+        Mif::PoolAllocator frames(256);
+        Awaiters awaiters;
+        std::vector<int> seen;
+        std::vector<Mif::Script> scripts;
+
+        {
+            Mif::ScriptFrames scope(frames);
+
+            for (uint32_t i = 0; i < kNumScripts; i++)
+            {
+                scripts.push_back(countFalls(awaiters, 1, seen));
+            }
+        }
+
+        EXPECT_EQ(frames.getNumAllocated(), kNumScripts);
+
+        // outside the scope frames come from the heap again
+        Mif::Script heap = countFalls(awaiters, 1, seen);
+        EXPECT_EQ(frames.getNumAllocated(), kNumScripts);
+        EXPECT_EQ(awaiters.numWaiting(EVENT_FELL), kNumScripts + 1);
+
+        EXPECT_EQ(awaiters.resume(7, EVENT_FELL), kNumScripts + 1);
+        EXPECT_EQ(seen.size(), kNumScripts + 1);
+
+        scripts.clear();
+        EXPECT_EQ(frames.getNumAllocated(), 0);
+    }
+
+
+    TEST(EventAwaiterTest, destroyedScriptStopsWaiting)
+    {
+        Awaiters awaiters;
+        std::vector<int> seen;
+
+        {
+            Mif::Script a = jumpThenFall(awaiters, seen);
+            Mif::Script b = jumpThenFall(awaiters, seen);
+            EXPECT_EQ(awaiters.numWaiting(EVENT_JUMPED), 2);
+        }
+
+        EXPECT_EQ(awaiters.numWaiting(EVENT_JUMPED), 0);
+        EXPECT_EQ(awaiters.resume(1, EVENT_JUMPED), 0);
+
+        Mif::Script c = jumpThenFall(awaiters, seen);
+        awaiters.resume(2, EVENT_JUMPED);
+        EXPECT_EQ(awaiters.numWaiting(EVENT_FELL), 1);
+        awaiters.resume(3, EVENT_FELL);
+
+        EXPECT_TRUE(c.done());
+        EXPECT_EQ(seen, std::vector<int>({ 2, 3 }));
+    }
+
+
+    TEST(EventAwaiterTest, awaitersOutlivedByScripts)
+    {
+        alignas(Awaiters) unsigned char storage[sizeof(Awaiters)];
+        Awaiters* const awaiters = new (storage) Awaiters();
+        std::vector<int> seen;
+
+        Mif::Script a = countFalls(*awaiters, 1, seen);
+        Mif::Script b = jumpThenFall(*awaiters, seen);
+        EXPECT_EQ(awaiters->numWaiting(EVENT_FELL), 1);
+
+        awaiters->~Awaiters();
+
+        // a waiter still linked to the dead lists would write into them
+        memset(storage, 0xa5, sizeof(storage));
+        a = Mif::Script();
+        b = Mif::Script();
+
+        for (size_t i = 0; i < sizeof(storage); i++)
+        {
+            EXPECT_EQ(storage[i], 0xa5);
+        }
+
+        EXPECT_TRUE(seen.empty());
+    }
+
+} // namespace anonymouse
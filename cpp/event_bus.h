@@ -0,0 +1,250 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+// reference: http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+
+namespace Mif {
+
+    const size_t kCacheLineSize = 64;
+
+    // Bounded lock-free multi-producer/multi-consumer queue.
+    // Each cell carries a sequence number which tells whether it is ready
+    // to be written (seq == pos) or read (seq == pos + 1), so producers and
+    // consumers only contend on their own position counter.
+    template <typename T>
+    class MpmcQueue {
+    public:
+        explicit MpmcQueue(uint32_t capacity);
+
+        MpmcQueue(const MpmcQueue&) = delete;
+        MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+        bool tryPush(const T& value);
+        bool tryPop(T& value);
+
+        uint32_t capacity() const { return m_mask + 1; }
+
+        // approximate, only meaningful when the queue is quiescent
+        size_t size() const
+        {
+            return m_enqueuePos.load(std::memory_order_relaxed) - m_dequeuePos.load(std::memory_order_relaxed);
+        }
+
+    private:
+        struct Cell {
+            std::atomic<size_t> seq;
+            T data;
+        };
+
+        std::unique_ptr<Cell[]> m_cells;
+        const size_t m_mask;
+
+        alignas(kCacheLineSize) std::atomic<size_t> m_enqueuePos;
+        alignas(kCacheLineSize) std::atomic<size_t> m_dequeuePos;
+    };
+
+
+    template <typename T>
+    MpmcQueue<T>::MpmcQueue(uint32_t capacity)
+    : m_cells(new Cell[capacity])
+    , m_mask(capacity - 1)
+    , m_enqueuePos(0)
+    , m_dequeuePos(0)
+    {
+        assert(capacity >= 2 && (capacity & (capacity - 1)) == 0 && "capacity must be a power of 2");
+
+        for (size_t i = 0; i < capacity; i++)
+        {
+            m_cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+
+    template <typename T>
+    bool MpmcQueue<T>::tryPush(const T& value)
+    {
+        size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+
+        for (;;)
+        {
+            cell = &m_cells[pos & m_mask];
+            const size_t seq = cell->seq.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+            if (diff == 0)
+            {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                return false; // full
+            }
+            else
+            {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->data = value;
+        cell->seq.store(pos + 1, std::memory_order_release);
+
+        return true;
+    }
+
+
+    template <typename T>
+    bool MpmcQueue<T>::tryPop(T& value)
+    {
+        size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+
+        for (;;)
+        {
+            cell = &m_cells[pos & m_mask];
+            const size_t seq = cell->seq.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+
+            if (diff == 0)
+            {
+                if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                return false; // empty
+            }
+            else
+            {
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        value = cell->data;
+        cell->seq.store(pos + m_mask + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /***************************************************************/
+
+    enum class Backpressure {
+        BLOCK,        // publisher spins/yields until there is room
+        DROP_OLDEST,  // publisher evicts the oldest queued event
+        DROP_NEWEST,  // publisher discards the event it is publishing
+    };
+
+    // Event bus on top of MpmcQueue.
+    // Events published by one producer thread are dequeued in the order
+    // they were published. With a single dispatcher thread that is also the
+    // order observers see them; with several dispatchers, events are handed
+    // out in order but may be processed concurrently.
+    template <typename T>
+    class EventBus {
+    public:
+        EventBus(uint32_t capacity, Backpressure policy)
+        : m_queue(capacity)
+        , m_policy(policy)
+        , m_dropped(0)
+        , m_closed(false)
+        {
+            ;
+        }
+
+        // returns false when the event (or, for DROP_OLDEST, an older one) was dropped
+        bool publish(const T& event);
+
+        bool tryConsume(T& event) { return m_queue.tryPop(event); }
+
+        // pops up to maxCount events and calls f(const T&) on each of them
+        template <typename F>
+        size_t consume(F f, size_t maxCount);
+
+        // wakes up blocked publishers; from then on a BLOCK publish that
+        // finds the queue full is dropped instead of waiting
+        void close() { m_closed.store(true, std::memory_order_release); }
+        bool closed() const { return m_closed.load(std::memory_order_acquire); }
+
+        Backpressure policy() const { return m_policy; }
+        uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+        uint32_t capacity() const { return m_queue.capacity(); }
+
+    private:
+        MpmcQueue<T> m_queue;
+        const Backpressure m_policy;
+        std::atomic<uint64_t> m_dropped;
+        std::atomic<bool> m_closed;
+    };
+
+
+    template <typename T>
+    bool EventBus<T>::publish(const T& event)
+    {
+        if (m_queue.tryPush(event))
+            return true;
+
+        switch (m_policy)
+        {
+        case Backpressure::BLOCK:
+            for (uint32_t spin = 0; !m_queue.tryPush(event); spin++)
+            {
+                if (closed())
+                {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+
+                if (spin >= 64)
+                    std::this_thread::yield();
+            }
+            return true;
+
+        case Backpressure::DROP_OLDEST:
+        {
+            bool evicted = false;
+
+            do {
+                T oldest;
+
+                if (m_queue.tryPop(oldest))
+                {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                    evicted = true;
+                }
+            } while (!m_queue.tryPush(event));
+
+            return !evicted;
+        }
+
+        case Backpressure::DROP_NEWEST:
+        default:
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+
+    template <typename T>
+    template <typename F>
+    size_t EventBus<T>::consume(F f, size_t maxCount)
+    {
+        size_t count = 0;
+        T event;
+
+        while (count < maxCount && m_queue.tryPop(event))
+        {
+            f(event);
+            count++;
+        }
+
+        return count;
+    }
+
+} // namespace Mif
@@ -0,0 +1,154 @@
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include "event_bus.h"
+
+using namespace std;
+
+// Compares Mif::EventBus against a mutex protected queue with
+// 1..64 producer threads feeding a single consumer thread.
+
+#define VPRINTF(...) \
+    do { \
+        printf(__VA_ARGS__); \
+    } while (false)
+
+namespace {
+
+    const uint32_t kCapacity = 4096;
+    const uint64_t kTotalEvents = 4 * 1000 * 1000;
+
+    struct BenchEvent
+    {
+        uint32_t producer;
+        uint32_t sequence;
+    };
+
+    class MutexQueue
+    {
+    public:
+        explicit MutexQueue(size_t capacity)
+            : capacity_(capacity)
+        {}
+
+        void push(const BenchEvent& event)
+        {
+            unique_lock<mutex> lock(mutex_);
+            notFull_.wait(lock, [this]() { return queue_.size() < capacity_; });
+            queue_.push_back(event);
+        }
+
+        size_t popBatch(BenchEvent* out, size_t maxCount)
+        {
+            size_t count = 0;
+            {
+                lock_guard<mutex> lock(mutex_);
+
+                while (count < maxCount && !queue_.empty())
+                {
+                    out[count++] = queue_.front();
+                    queue_.pop_front();
+                }
+            }
+
+            if (count > 0)
+                notFull_.notify_all();
+
+            return count;
+        }
+
+    private:
+        const size_t capacity_;
+        deque<BenchEvent> queue_;
+        mutex mutex_;
+        condition_variable notFull_;
+    };
+
+
+    template <typename Publish, typename Consume>
+    double run(uint32_t numProducers, Publish publish, Consume consume)
+    {
+        const uint64_t perProducer = kTotalEvents / numProducers;
+        const uint64_t total = perProducer * numProducers;
+
+        const auto start = chrono::steady_clock::now();
+
+        vector<thread> producers;
+
+        for (uint32_t p = 0; p < numProducers; p++)
+        {
+            producers.emplace_back([=]() {
+                for (uint32_t i = 0; i < perProducer; i++)
+                {
+                    const BenchEvent event = { p, i };
+                    publish(event);
+                }
+            });
+        }
+
+        uint64_t received = 0;
+
+        while (received < total)
+        {
+            const size_t n = consume();
+
+            if (n == 0)
+                this_thread::yield();
+
+            received += n;
+        }
+
+        for (thread& t : producers)
+        {
+            t.join();
+        }
+
+        const chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+        return total / elapsed.count();
+    }
+
+} // namespace anonymouse
+
+
+int main()
+{
+    VPRINTF("%10s %18s %18s\n", "producers", "lock-free ev/s", "mutex ev/s");
+
+    for (uint32_t producers = 1; producers <= 64; producers *= 2)
+    {
+        Mif::EventBus<BenchEvent> bus(kCapacity, Mif::Backpressure::BLOCK);
+        uint64_t checksum = 0;
+
+        const double lockFree = run(producers,
+            [&bus](const BenchEvent& event) { bus.publish(event); },
+            [&bus, &checksum]() {
+                return bus.consume([&checksum](const BenchEvent& event) { checksum += event.sequence; }, 256);
+            });
+
+        MutexQueue queue(kCapacity);
+        BenchEvent batch[256];
+
+        const double locked = run(producers,
+            [&queue](const BenchEvent& event) { queue.push(event); },
+            [&queue, &batch, &checksum]() {
+                const size_t n = queue.popBatch(batch, 256);
+
+                for (size_t i = 0; i < n; i++)
+                {
+                    checksum += batch[i].sequence;
+                }
+
+                return n;
+            });
+
+        VPRINTF("%10u %18.0f %18.0f (checksum %llu)\n", producers, lockFree, locked, (unsigned long long)checksum);
+    }
+
+    return 0;
+}
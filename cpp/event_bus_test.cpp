@@ -0,0 +1,144 @@
+#include <cstdio>
+#include <vector>
+#include <thread>
+#include "event_bus.h"
+#include "gtest/gtest.h"
+
+namespace { // for constants
+    const uint32_t kCapacity = 8;
+
+    struct Message
+    {
+        uint32_t producer;
+        uint32_t sequence;
+    };
+} // namespace anonymouse
+
+
+namespace { // for functions
+
+    TEST(MpmcQueueTest, fifo)
+    {
+        Mif::MpmcQueue<int> queue(kCapacity);
+        int value;
+
+        EXPECT_EQ(queue.capacity(), kCapacity);
+        EXPECT_FALSE(queue.tryPop(value));
+
+        for (uint32_t i = 0; i < kCapacity; i++)
+        {
+            EXPECT_TRUE(queue.tryPush(i));
+        }
+
+        EXPECT_FALSE(queue.tryPush(-1));
+        EXPECT_EQ(queue.size(), kCapacity);
+
+        for (uint32_t i = 0; i < kCapacity; i++)
+        {
+            EXPECT_TRUE(queue.tryPop(value));
+            EXPECT_EQ(value, (int)i);
+        }
+
+        EXPECT_FALSE(queue.tryPop(value));
+    }
+
+
+    TEST(EventBusTest, dropNewest)
+    {
+        Mif::EventBus<int> bus(kCapacity, Mif::Backpressure::DROP_NEWEST);
+
+        for (uint32_t i = 0; i < kCapacity + 3; i++)
+        {
+            EXPECT_EQ(bus.publish(i), i < kCapacity);
+        }
+
+        EXPECT_EQ(bus.dropped(), 3);
+
+        std::vector<int> received;
+        bus.consume([&received](int v) { received.push_back(v); }, 100);
+
+        ASSERT_EQ(received.size(), kCapacity);
+        EXPECT_EQ(received.front(), 0);
+        EXPECT_EQ(received.back(), (int)kCapacity - 1);
+    }
+
+
+    TEST(EventBusTest, dropOldest)
+    {
+        Mif::EventBus<int> bus(kCapacity, Mif::Backpressure::DROP_OLDEST);
+
+        for (uint32_t i = 0; i < kCapacity + 3; i++)
+        {
+            EXPECT_EQ(bus.publish(i), i < kCapacity);
+        }
+
+        EXPECT_EQ(bus.dropped(), 3);
+
+        std::vector<int> received;
+        bus.consume([&received](int v) { received.push_back(v); }, 100);
+
+        ASSERT_EQ(received.size(), kCapacity);
+        EXPECT_EQ(received.front(), 3);
+        EXPECT_EQ(received.back(), (int)kCapacity + 2);
+    }
+
+
+    TEST(EventBusTest, blockClosed)
+    {
+        Mif::EventBus<int> bus(kCapacity, Mif::Backpressure::BLOCK);
+
+        for (uint32_t i = 0; i < kCapacity; i++)
+        {
+            EXPECT_TRUE(bus.publish(i));
+        }
+
+        bus.close();
+        EXPECT_FALSE(bus.publish(-1));
+        EXPECT_EQ(bus.dropped(), 1);
+    }
+
+
+    TEST(EventBusTest, perProducerOrder)
+    {
+        const uint32_t kProducers = 4;
+        const uint32_t kMessages = 5000;
+
+        Mif::EventBus<Message> bus(64, Mif::Backpressure::BLOCK);
+        std::vector<std::thread> producers;
+
+        for (uint32_t p = 0; p < kProducers; p++)
+        {
+            producers.emplace_back([&bus, p]() {
+                for (uint32_t i = 0; i < kMessages; i++)
+                {
+                    const Message m = { p, i };
+                    bus.publish(m);
+                }
+            });
+        }
+
+        std::vector<uint32_t> next(kProducers, 0);
+        uint32_t received = 0;
+
+        while (received < kProducers * kMessages)
+        {
+            received += bus.consume([&next](const Message& m) {
+                EXPECT_EQ(m.sequence, next[m.producer]);
+                next[m.producer] = m.sequence + 1;
+            }, 16);
+        }
+
+        for (std::thread& t : producers)
+        {
+            t.join();
+        }
+
+        EXPECT_EQ(bus.dropped(), 0);
+
+        for (uint32_t p = 0; p < kProducers; p++)
+        {
+            EXPECT_EQ(next[p], kMessages);
+        }
+    }
+
+} // namespace anonymouse
@@ -0,0 +1,363 @@
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+#include "event_fanout.h"
+#include "fd_channel.h"  // makeUnixAddress
+
+namespace Mif {
+
+    namespace {
+        const uint32_t kWireMagic = 0x4546494d; // "MIFE"
+        const uint16_t kWireVersion = 1;
+
+        bool sameAddress(const sockaddr_un& a, socklen_t aLength, const sockaddr_un& b, socklen_t bLength)
+        {
+            return aLength == bLength && memcmp(&a, &b, aLength) == 0;
+        }
+
+        // binds a fresh datagram socket to path; -1 with errno on failure
+        int bindDatagram(const char* path)
+        {
+            sockaddr_un addr;
+            socklen_t length;
+
+            if (!makeUnixAddress(path, addr, length))
+                return -1;
+
+            const int s = socket(PF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+
+            if (s < 0)
+                return -1;
+
+            unlink(path);
+
+            if (bind(s, reinterpret_cast<sockaddr*>(&addr), length) < 0)
+            {
+                const int err = errno;
+                ::close(s);
+                errno = err;
+                return -1;
+            }
+
+            return s;
+        }
+
+        WireHeader makeHeader(WireType type, uint32_t sequence, uint32_t count)
+        {
+            const WireHeader header = { kWireMagic, kWireVersion, static_cast<uint16_t>(type), sequence, count };
+            return header;
+        }
+
+        bool validHeader(const WireHeader& header)
+        {
+            return header.magic == kWireMagic && header.version == kWireVersion;
+        }
+    } // namespace anonymouse
+
+
+    EventPublisher::EventPublisher()
+    : m_socket(-1)
+    , m_sequence(0)
+    , m_count(0)
+    , m_dropped(0)
+    , m_records(kMaxBatch)
+    {
+        ;
+    }
+
+
+    EventPublisher::~EventPublisher()
+    {
+        close();
+    }
+
+
+    bool EventPublisher::open(const char* path)
+    {
+        close();
+
+        m_socket = bindDatagram(path);
+
+        if (m_socket < 0)
+            return false;
+
+        m_path = path;
+        return true;
+    }
+
+
+    void EventPublisher::close()
+    {
+        if (m_socket < 0)
+            return;
+
+        ::close(m_socket);
+        unlink(m_path.c_str());
+
+        m_socket = -1;
+        m_path.clear();
+        m_subscribers.clear();
+        m_count = 0;
+    }
+
+
+    uint32_t EventPublisher::pollSubscriptions()
+    {
+        for (;;)
+        {
+            WireHeader header;
+            sockaddr_un addr;
+            socklen_t length = sizeof(addr);
+
+            const ssize_t n = recvfrom(m_socket, &header, sizeof(header), MSG_DONTWAIT,
+                    reinterpret_cast<sockaddr*>(&addr), &length);
+
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+
+                break;  // EAGAIN: nothing left
+            }
+
+            // an unbound sender cannot be sent to
+            if (n != sizeof(header) || !validHeader(header) || length <= offsetof(sockaddr_un, sun_path))
+                continue;
+
+            if (header.type == static_cast<uint16_t>(WireType::SUBSCRIBE))
+                addSubscriber(addr, length);
+            else if (header.type == static_cast<uint16_t>(WireType::UNSUBSCRIBE))
+                removeSubscriber(addr, length);
+        }
+
+        return numSubscribers();
+    }
+
+
+    uint32_t EventPublisher::flush()
+    {
+        const uint32_t count = m_count;
+        m_count = 0;
+
+        if (count == 0 || m_subscribers.empty())
+            return 0;
+
+        WireHeader header = makeHeader(WireType::BATCH, m_sequence++, count);
+
+        // every message shares the same two buffers, only the address differs
+        iovec iov[2];
+        iov[0].iov_base = &header;
+        iov[0].iov_len = sizeof(header);
+        iov[1].iov_base = m_records.data();
+        iov[1].iov_len = count * sizeof(WireRecord);
+
+        const uint32_t n = numSubscribers();
+        std::vector<mmsghdr> messages(n);
+
+        for (uint32_t i = 0; i < n; i++)
+        {
+            msghdr& msg = messages[i].msg_hdr;
+            memset(&msg, 0, sizeof(msg));
+            msg.msg_name = &m_subscribers[i].addr;
+            msg.msg_namelen = m_subscribers[i].length;
+            msg.msg_iov = iov;
+            msg.msg_iovlen = 2;
+        }
+
+        std::vector<uint8_t> gone(n, 0);
+        uint32_t delivered = 0;
+        uint32_t i = 0;
+
+        while (i < n)
+        {
+            const int sent = sendmmsg(m_socket, &messages[i], n - i, MSG_DONTWAIT);
+
+            if (sent > 0)
+            {
+                delivered += sent;
+                i += sent;
+                continue;
+            }
+
+            // sendmmsg() stops at the first failing message
+            if (errno == EINTR)
+                continue;
+
+            if (errno == ECONNREFUSED || errno == ENOENT)
+                gone[i] = 1;   // subscriber exited without unsubscribing
+            else
+                m_dropped++;   // EAGAIN: its receive buffer is full
+
+            i++;
+        }
+
+        uint32_t kept = 0;
+
+        for (uint32_t j = 0; j < n; j++)
+        {
+            if (!gone[j])
+                m_subscribers[kept++] = m_subscribers[j];
+        }
+
+        m_subscribers.resize(kept);
+        return delivered;
+    }
+
+
+    void EventPublisher::addSubscriber(const sockaddr_un& addr, socklen_t length)
+    {
+        for (const Subscriber& s : m_subscribers)
+        {
+            if (sameAddress(s.addr, s.length, addr, length))
+                return;
+        }
+
+        Subscriber s;
+        s.addr = addr;
+        s.length = length;
+        m_subscribers.push_back(s);
+    }
+
+
+    void EventPublisher::removeSubscriber(const sockaddr_un& addr, socklen_t length)
+    {
+        for (size_t i = 0; i < m_subscribers.size(); i++)
+        {
+            if (sameAddress(m_subscribers[i].addr, m_subscribers[i].length, addr, length))
+            {
+                m_subscribers.erase(m_subscribers.begin() + i);
+                return;
+            }
+        }
+    }
+
+
+    EventSubscriber::EventSubscriber()
+    : m_socket(-1)
+    , m_started(false)
+    , m_nextSequence(0)
+    , m_lost(0)
+    , m_buffers(kMaxBatchesPerPoll * kMaxDatagram)
+    {
+        memset(&m_publisher, 0, sizeof(m_publisher));
+    }
+
+
+    EventSubscriber::~EventSubscriber()
+    {
+        close();
+    }
+
+
+    bool EventSubscriber::open(const char* path, const char* publisherPath)
+    {
+        close();
+
+        socklen_t length;
+
+        if (!makeUnixAddress(publisherPath, m_publisher, length))
+            return false;
+
+        m_socket = bindDatagram(path);
+
+        if (m_socket < 0)
+            return false;
+
+        m_path = path;
+
+        const WireHeader header = makeHeader(WireType::SUBSCRIBE, 0, 0);
+
+        if (sendto(m_socket, &header, sizeof(header), 0, reinterpret_cast<const sockaddr*>(&m_publisher), length) < 0)
+        {
+            const int err = errno;
+            close();
+            errno = err;
+            return false;
+        }
+
+        return true;
+    }
+
+
+    void EventSubscriber::close()
+    {
+        if (m_socket < 0)
+            return;
+
+        // best effort; the publisher also notices when the path is gone
+        const WireHeader header = makeHeader(WireType::UNSUBSCRIBE, 0, 0);
+        sendto(m_socket, &header, sizeof(header), MSG_DONTWAIT, reinterpret_cast<const sockaddr*>(&m_publisher),
+                static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + strlen(m_publisher.sun_path) + 1));
+
+        ::close(m_socket);
+        unlink(m_path.c_str());
+
+        m_socket = -1;
+        m_path.clear();
+        m_started = false;
+    }
+
+
+    int EventSubscriber::receive(int timeoutMs)
+    {
+        pollfd pfd = { m_socket, POLLIN, 0 };
+        int ready;
+
+        do {
+            ready = ::poll(&pfd, 1, timeoutMs);
+        } while (ready < 0 && errno == EINTR);
+
+        if (ready <= 0)
+            return ready;
+
+        mmsghdr messages[kMaxBatchesPerPoll];
+        iovec iov[kMaxBatchesPerPoll];
+
+        for (uint32_t i = 0; i < kMaxBatchesPerPoll; i++)
+        {
+            iov[i].iov_base = m_buffers.data() + i * kMaxDatagram;
+            iov[i].iov_len = kMaxDatagram;
+
+            msghdr& msg = messages[i].msg_hdr;
+            memset(&msg, 0, sizeof(msg));
+            msg.msg_iov = &iov[i];
+            msg.msg_iovlen = 1;
+        }
+
+        const int n = recvmmsg(m_socket, messages, kMaxBatchesPerPoll, MSG_DONTWAIT, nullptr);
+
+        if (n < 0)
+            return (errno == EAGAIN || errno == EINTR) ? 0 : -1;
+
+        for (int i = 0; i < n; i++)
+        {
+            m_lengths[i] = (messages[i].msg_hdr.msg_flags & MSG_TRUNC) ? 0 : messages[i].msg_len;
+        }
+
+        return n;
+    }
+
+
+    bool EventSubscriber::accept(const uint8_t* datagram, size_t length)
+    {
+        if (length < sizeof(WireHeader))
+            return false;
+
+        const WireHeader* const header = reinterpret_cast<const WireHeader*>(datagram);
+
+        if (!validHeader(*header) || header->type != static_cast<uint16_t>(WireType::BATCH)
+                || length != sizeof(WireHeader) + static_cast<size_t>(header->count) * sizeof(WireRecord))
+            return false;
+
+        if (m_started && header->sequence != m_nextSequence)
+            m_lost += header->sequence - m_nextSequence;
+
+        m_nextSequence = header->sequence + 1;
+        m_started = true;
+
+        return true;
+    }
+
+} // namespace Mif
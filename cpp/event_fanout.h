@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// Cross-process event fan-out over PF_UNIX datagram sockets.
+//
+// Every process binds its own socket path. A subscriber registers by sending
+// one control datagram to the publisher's path; after that the publisher
+// writes batches straight to each subscriber with one sendmmsg() call per
+// flush, so there is no broker process between them.
+//
+// Datagrams keep batch boundaries, so a batch is received whole or not at all.
+
+namespace Mif {
+
+    // fixed wire layout in host byte order (same-host PF_UNIX only),
+    // 16-byte header + 16 bytes per event
+    struct WireHeader {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t type;       // WireType
+        uint32_t sequence;   // per publisher, to detect lost batches
+        uint32_t count;      // records following the header
+    };
+
+    struct WireRecord {
+        uint64_t entity;     // Handle::bits() or any other 64-bit id
+        uint32_t event;
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(WireHeader) == 16 && sizeof(WireRecord) == 16, "wire layout changed");
+
+    enum class WireType : uint16_t {
+        SUBSCRIBE = 1,
+        UNSUBSCRIBE,
+        BATCH,
+    };
+
+
+    class EventPublisher {
+    public:
+        // records per datagram; 16 KiB + header, well below the default
+        // AF_UNIX datagram limit
+        static const uint32_t kMaxBatch = 1024;
+
+        EventPublisher();
+        ~EventPublisher();
+
+        EventPublisher(const EventPublisher&) = delete;
+        EventPublisher& operator=(const EventPublisher&) = delete;
+
+        // binds path, replacing a stale socket file; returns false and sets
+        // errno on failure
+        bool open(const char* path);
+        void close();
+
+        // handles pending (un)subscribe requests without blocking;
+        // returns the number of subscribers
+        uint32_t pollSubscriptions();
+
+        // buffers one event; a full batch is flushed right away
+        void publish(uint64_t entity, uint32_t event)
+        {
+            WireRecord& r = m_records[m_count++];
+            r.entity = entity;
+            r.event = event;
+            r.reserved = 0;
+
+            if (m_count == kMaxBatch)
+                flush();
+        }
+
+        // sends the buffered batch to every subscriber with one sendmmsg().
+        // A subscriber whose receive buffer is full misses this batch; one
+        // that went away is dropped. Returns the number of deliveries.
+        uint32_t flush();
+
+        uint32_t numSubscribers() const { return static_cast<uint32_t>(m_subscribers.size()); }
+        uint32_t pending() const { return m_count; }
+        uint64_t dropped() const { return m_dropped; }
+
+    private:
+        void addSubscriber(const sockaddr_un& addr, socklen_t length);
+        void removeSubscriber(const sockaddr_un& addr, socklen_t length);
+
+        int m_socket;
+        std::string m_path;
+        uint32_t m_sequence;
+        uint32_t m_count;
+        uint64_t m_dropped;
+        std::vector<WireRecord> m_records;
+
+        struct Subscriber {
+            sockaddr_un addr;
+            socklen_t length;
+        };
+
+        std::vector<Subscriber> m_subscribers;
+    };
+
+
+    class EventSubscriber {
+    public:
+        // datagrams read per recvmmsg() call
+        static const uint32_t kMaxBatchesPerPoll = 16;
+        static const size_t kMaxDatagram = sizeof(WireHeader) + EventPublisher::kMaxBatch * sizeof(WireRecord);
+
+        EventSubscriber();
+        ~EventSubscriber();
+
+        EventSubscriber(const EventSubscriber&) = delete;
+        EventSubscriber& operator=(const EventSubscriber&) = delete;
+
+        // binds path and subscribes to the publisher at publisherPath
+        bool open(const char* path, const char* publisherPath);
+
+        // unsubscribes and closes
+        void close();
+
+        // waits up to timeoutMs (-1: forever, 0: not at all) for batches and
+        // calls onBatch(const WireRecord* records, uint32_t count) for each;
+        // returns the number of batches, or -1 with errno set
+        template<typename OnBatch>
+        int poll(int timeoutMs, OnBatch&& onBatch);
+
+        // batches the publisher sent but this subscriber never saw
+        uint64_t lost() const { return m_lost; }
+
+        int fd() const { return m_socket; }
+
+    private:
+        int receive(int timeoutMs);
+        bool accept(const uint8_t* datagram, size_t length);
+
+        int m_socket;
+        std::string m_path;
+        sockaddr_un m_publisher;
+        bool m_started;
+        uint32_t m_nextSequence;
+        uint64_t m_lost;
+
+        std::vector<uint8_t> m_buffers;  // kMaxBatchesPerPoll datagrams
+        uint32_t m_lengths[kMaxBatchesPerPoll];
+    };
+
+
+    template<typename OnBatch>
+    int EventSubscriber::poll(int timeoutMs, OnBatch&& onBatch)
+    {
+        const int n = receive(timeoutMs);
+        int batches = 0;
+
+        for (int i = 0; i < n; i++)
+        {
+            const uint8_t* const datagram = m_buffers.data() + i * kMaxDatagram;
+
+            if (!accept(datagram, m_lengths[i]))
+                continue;
+
+            const WireHeader* const header = reinterpret_cast<const WireHeader*>(datagram);
+            onBatch(reinterpret_cast<const WireRecord*>(header + 1), header->count);
+            batches++;
+        }
+
+        return n < 0 ? -1 : batches;
+    }
+
+} // namespace Mif
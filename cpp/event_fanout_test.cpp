@@ -0,0 +1,152 @@
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+#include "event_fanout.h"
+#include "gtest/gtest.h"
+
+namespace { // for constants
+    const uint32_t kNumSubscribers = 3;
+    const uint32_t kNumEvents = 2500;  // two full batches and a partial one
+} // namespace anonymouse
+
+namespace { // for test fixture
+    class EventFanOutTest : public ::testing::Test
+    {
+    public:
+        void SetUp();
+        void TearDown();
+
+        std::string path(const char* name) const { return prefix_ + name; }
+
+        std::string prefix_;
+        Mif::EventPublisher publisher_;
+        Mif::EventSubscriber subscribers_[kNumSubscribers];
+    };
+
+    void EventFanOutTest::SetUp()
+    {
+        prefix_ = "/tmp/event_fanout_test_" + std::to_string(getpid()) + "_";
+        ASSERT_TRUE(publisher_.open(path("pub").c_str()));
+
+        for (uint32_t i = 0; i < kNumSubscribers; i++)
+        {
+            ASSERT_TRUE(subscribers_[i].open(path(std::to_string(i).c_str()).c_str(), path("pub").c_str()));
+        }
+
+        EXPECT_EQ(publisher_.pollSubscriptions(), kNumSubscribers);
+    }
+
+    void EventFanOutTest::TearDown()
+    {
+        for (uint32_t i = 0; i < kNumSubscribers; i++)
+        {
+            subscribers_[i].close();
+        }
+
+        publisher_.close();
+    }
+} // namespace anonymouse
+
+
+namespace { // for functions
+
+    TEST_F(EventFanOutTest, batchesReachEverySubscriber)
+    {
+        for (uint32_t i = 0; i < kNumEvents; i++)
+        {
+            publisher_.publish(1000 + i, i % 3);
+        }
+
+        EXPECT_EQ(publisher_.pending(), kNumEvents % Mif::EventPublisher::kMaxBatch);
+        EXPECT_EQ(publisher_.flush(), kNumSubscribers);
+        EXPECT_EQ(publisher_.pending(), 0);
+
+        for (uint32_t s = 0; s < kNumSubscribers; s++)
+        {
+            uint32_t next = 0;
+            uint32_t batches = 0;
+
+            while (next < kNumEvents)
+            {
+                const int n = subscribers_[s].poll(1000, [&next](const Mif::WireRecord* records, uint32_t count) {
+                    for (uint32_t i = 0; i < count; i++)
+                    {
+                        EXPECT_EQ(records[i].entity, 1000 + next);
+                        EXPECT_EQ(records[i].event, next % 3);
+                        next++;
+                    }
+                });
+
+                ASSERT_GT(n, 0);
+                batches += n;
+            }
+
+            EXPECT_EQ(batches, 3);
+            EXPECT_EQ(subscribers_[s].lost(), 0);
+        }
+    }
+
+
+    TEST_F(EventFanOutTest, unsubscribeAndVanish)
+    {
+        subscribers_[0].close();
+        EXPECT_EQ(publisher_.pollSubscriptions(), kNumSubscribers - 1);
+
+        // a subscriber whose socket disappears is dropped on the next flush
+        unlink(path("1").c_str());
+
+        publisher_.publish(1, 0);
+        EXPECT_EQ(publisher_.flush(), kNumSubscribers - 2);
+        EXPECT_EQ(publisher_.numSubscribers(), kNumSubscribers - 2);
+
+        uint32_t received = 0;
+        EXPECT_EQ(subscribers_[2].poll(1000, [&received](const Mif::WireRecord*, uint32_t count) { received += count; }), 1);
+        EXPECT_EQ(received, 1);
+
+        // nothing more is waiting
+        EXPECT_EQ(subscribers_[2].poll(0, [](const Mif::WireRecord*, uint32_t) {}), 0);
+    }
+
+
+    TEST_F(EventFanOutTest, detectsLostBatches)
+    {
+        // nobody reads, so the receive queues fill up and batches are dropped
+        for (uint32_t i = 0; i < 64; i++)
+        {
+            publisher_.publish(i, 0);
+            publisher_.flush();
+        }
+
+        ASSERT_GT(publisher_.dropped(), 0);
+
+        const auto drain = [](Mif::EventSubscriber& subscriber) {
+            while (subscriber.poll(0, [](const Mif::WireRecord*, uint32_t) {}) > 0)
+            {
+                ;
+            }
+        };
+
+        for (uint32_t s = 0; s < kNumSubscribers; s++)
+        {
+            drain(subscribers_[s]);
+        }
+
+        // the gap shows once a later batch arrives
+        publisher_.publish(64, 0);
+        EXPECT_EQ(publisher_.flush(), kNumSubscribers);
+
+        uint64_t lost = 0;
+
+        for (uint32_t s = 0; s < kNumSubscribers; s++)
+        {
+            EXPECT_EQ(subscribers_[s].poll(1000, [](const Mif::WireRecord* records, uint32_t) {
+                EXPECT_EQ(records[0].entity, 64);
+            }), 1);
+
+            lost += subscribers_[s].lost();
+        }
+
+        EXPECT_EQ(lost, publisher_.dropped());
+    }
+
+} // namespace anonymouse
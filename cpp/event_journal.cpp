@@ -0,0 +1,182 @@
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "event_journal.h"
+#include "memory_allocator.h"  // roundUpPow2
+
+namespace Mif {
+
+    namespace {
+        const uint32_t kJournalMagic = 0x4c4e524a; // "JRNL"
+        const uint32_t kJournalVersion = 1;
+
+        struct JournalHeader {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t recordSize;
+            uint32_t count;
+        };
+    } // namespace anonymouse
+
+
+    uint64_t readTimestamp()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+#endif
+    }
+
+
+    EventJournal::EventJournal(uint32_t capacity)
+    : m_records(roundUpPow2(capacity))
+    , m_mask(roundUpPow2(capacity) - 1)
+    , m_written(0)
+    {
+        assert(capacity > 0 && "journal needs at least one record");
+    }
+
+
+    bool EventJournal::flushToFile(const char* path) const
+    {
+        const uint32_t count = size();
+        const size_t length = sizeof(JournalHeader) + static_cast<size_t>(count) * sizeof(JournalRecord);
+
+        const int fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+        if (fd < 0)
+            return false;
+
+        if (ftruncate(fd, length) < 0)
+        {
+            const int err = errno;
+            ::close(fd);
+            errno = err;
+            return false;
+        }
+
+        void* const base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        const int err = errno;
+        ::close(fd);
+
+        if (base == MAP_FAILED)
+        {
+            errno = err;
+            return false;
+        }
+
+        const JournalHeader header = { kJournalMagic, kJournalVersion, sizeof(JournalRecord), count };
+        std::memcpy(base, &header, sizeof(header));
+
+        // the ring may wrap: copy [first, end) and then [0, rest)
+        JournalRecord* const out = reinterpret_cast<JournalRecord*>(static_cast<char*>(base) + sizeof(header));
+        const uint32_t start = static_cast<uint32_t>(first() & m_mask);
+        const uint32_t tail = count < capacity() - start ? count : capacity() - start;
+
+        std::memcpy(out, m_records.data() + start, tail * sizeof(JournalRecord));
+        std::memcpy(out + tail, m_records.data(), (count - tail) * sizeof(JournalRecord));
+
+        const bool ok = msync(base, length, MS_SYNC) == 0;
+        munmap(base, length);
+
+        return ok;
+    }
+
+
+    MappedJournal::MappedJournal()
+    : m_base(nullptr)
+    , m_length(0)
+    , m_records(nullptr)
+    , m_size(0)
+    {
+        ;
+    }
+
+
+    MappedJournal::~MappedJournal()
+    {
+        close();
+    }
+
+
+    bool MappedJournal::open(const char* path)
+    {
+        close();
+
+        const int fd = ::open(path, O_RDONLY);
+
+        if (fd < 0)
+            return false;
+
+        struct stat st;
+
+        if (fstat(fd, &st) < 0)
+        {
+            const int err = errno;
+            ::close(fd);
+            errno = err;
+            return false;
+        }
+
+        if (static_cast<size_t>(st.st_size) < sizeof(JournalHeader))
+        {
+            ::close(fd);
+            errno = EINVAL;
+            return false;
+        }
+
+        const size_t length = st.st_size;
+        void* const base = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        const int err = errno;
+        ::close(fd);
+
+        if (base == MAP_FAILED)
+        {
+            errno = err;
+            return false;
+        }
+
+        JournalHeader header;
+        std::memcpy(&header, base, sizeof(header));
+
+        if (header.magic != kJournalMagic || header.version != kJournalVersion
+                || header.recordSize != sizeof(JournalRecord)
+                || length < sizeof(header) + static_cast<size_t>(header.count) * sizeof(JournalRecord))
+        {
+            munmap(base, length);
+            errno = EINVAL;
+            return false;
+        }
+
+        m_base = base;
+        m_length = length;
+        m_records = reinterpret_cast<const JournalRecord*>(static_cast<const char*>(base) + sizeof(header));
+        m_size = header.count;
+
+        return true;
+    }
+
+
+    void MappedJournal::close()
+    {
+        if (m_base)
+            munmap(m_base, m_length);
+
+        m_base = nullptr;
+        m_length = 0;
+        m_records = nullptr;
+        m_size = 0;
+    }
+
+} // namespace Mif
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace Mif {
+
+    // one dispatched event, as stored in memory and on disk
+    struct JournalRecord {
+        uint64_t timestamp;  // readTimestamp() at notify time
+        uint64_t entity;     // Handle::bits() or any other 64-bit id
+        uint32_t event;
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(JournalRecord) == 24, "journal records are written as raw bytes");
+
+    // rdtsc on x86, CLOCK_MONOTONIC nanoseconds elsewhere
+    uint64_t readTimestamp();
+
+    // Fixed-capacity binary ring of dispatched events.
+    // The storage is allocated once; when full, the oldest record is
+    // overwritten so the journal always holds the most recent traffic.
+    // Not thread-safe: one journal per dispatching thread.
+    class EventJournal {
+    public:
+        // capacity is rounded up to a power of two
+        explicit EventJournal(uint32_t capacity);
+
+        void record(uint64_t entity, uint32_t event)
+        {
+            JournalRecord& r = m_records[m_written & m_mask];
+            r.timestamp = readTimestamp();
+            r.entity = entity;
+            r.event = event;
+            r.reserved = 0;
+            m_written++;
+        }
+
+        // i-th retained record, oldest first
+        const JournalRecord& at(uint32_t i) const { return m_records[(first() + i) & m_mask]; }
+
+        uint32_t size() const { return m_written < capacity() ? static_cast<uint32_t>(m_written) : capacity(); }
+        uint32_t capacity() const { return m_mask + 1; }
+        uint64_t overwritten() const { return m_written - size(); }
+        void clear() { m_written = 0; }
+
+        // writes the retained records, oldest first, through a shared
+        // mapping of path; returns false and sets errno on failure
+        bool flushToFile(const char* path) const;
+
+    private:
+        uint64_t first() const { return m_written - size(); }
+
+        std::vector<JournalRecord> m_records;
+        uint32_t m_mask;
+        uint64_t m_written;
+    };
+
+
+    // Read-only memory mapping of a file written by EventJournal::flushToFile().
+    class MappedJournal {
+    public:
+        MappedJournal();
+        ~MappedJournal();
+
+        MappedJournal(const MappedJournal&) = delete;
+        MappedJournal& operator=(const MappedJournal&) = delete;
+
+        // returns false and sets errno if the file is missing or malformed
+        bool open(const char* path);
+        void close();
+
+        const JournalRecord* records() const { return m_records; }
+        uint32_t size() const { return m_size; }
+
+    private:
+        void* m_base;
+        size_t m_length;
+        const JournalRecord* m_records;
+        uint32_t m_size;
+    };
+
+
+    // Re-runs a recorded stream at full speed, ignoring the original timing.
+    // dispatch is called as dispatch(entity, event) in recorded order.
+    template<typename Dispatch>
+    uint32_t replay(const JournalRecord* records, uint32_t count, Dispatch&& dispatch)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            dispatch(records[i].entity, records[i].event);
+        }
+
+        return count;
+    }
+
+} // namespace Mif
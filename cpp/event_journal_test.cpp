@@ -0,0 +1,101 @@
+#include <cstdio>
+#include <cerrno>
+#include <vector>
+#include <unistd.h>
+#include "event_journal.h"
+#include "gtest/gtest.h"
+
+namespace { // for constants
+    const uint32_t kCapacity = 8;
+} // namespace anonymouse
+
+
+namespace { // for functions
+
+    TEST(EventJournalTest, ringOverwritesOldest)
+    {
+        Mif::EventJournal journal(kCapacity - 1);  // rounded up
+        EXPECT_EQ(journal.capacity(), kCapacity);
+
+        for (uint32_t i = 0; i < kCapacity + 3; i++)
+        {
+            journal.record(100 + i, i % 2);
+        }
+
+        EXPECT_EQ(journal.size(), kCapacity);
+        EXPECT_EQ(journal.overwritten(), 3);
+
+        for (uint32_t i = 0; i < kCapacity; i++)
+        {
+            EXPECT_EQ(journal.at(i).entity, 103 + i);
+            EXPECT_EQ(journal.at(i).event, (3 + i) % 2);
+        }
+
+        // timestamps are monotonic in recording order
+        for (uint32_t i = 1; i < kCapacity; i++)
+        {
+            EXPECT_GE(journal.at(i).timestamp, journal.at(i - 1).timestamp);
+        }
+    }
+
+
+    TEST(EventJournalTest, flushAndReplay)
+    {
+        char path[] = "/tmp/event_journal_test_XXXXXX";
+        const int fd = mkstemp(path);
+        ASSERT_GE(fd, 0);
+        close(fd);
+
+        Mif::EventJournal journal(kCapacity);
+
+        for (uint32_t i = 0; i < kCapacity + 5; i++)  // wraps the ring
+        {
+            journal.record(i, i % 3);
+        }
+
+        ASSERT_TRUE(journal.flushToFile(path));
+
+        Mif::MappedJournal mapped;
+        ASSERT_TRUE(mapped.open(path));
+        ASSERT_EQ(mapped.size(), kCapacity);
+
+        std::vector<uint64_t> entities;
+        const uint32_t n = Mif::replay(mapped.records(), mapped.size(), [&entities](uint64_t entity, uint32_t event) {
+            EXPECT_EQ(event, entity % 3);
+            entities.push_back(entity);
+        });
+
+        EXPECT_EQ(n, kCapacity);
+
+        for (uint32_t i = 0; i < kCapacity; i++)
+        {
+            EXPECT_EQ(entities[i], 5 + i);
+            EXPECT_EQ(mapped.records()[i].timestamp, journal.at(i).timestamp);
+        }
+
+        mapped.close();
+        unlink(path);
+    }
+
+
+    TEST(EventJournalTest, rejectsBadFiles)
+    {
+        Mif::MappedJournal mapped;
+
+        EXPECT_FALSE(mapped.open("/tmp/event_journal_test_missing"));
+        EXPECT_EQ(errno, ENOENT);
+
+        char path[] = "/tmp/event_journal_test_XXXXXX";
+        const int fd = mkstemp(path);
+        ASSERT_GE(fd, 0);
+        ASSERT_EQ(write(fd, "not a journal, just text", 24), 24);
+        close(fd);
+
+        EXPECT_FALSE(mapped.open(path));
+        EXPECT_EQ(errno, EINVAL);
+        EXPECT_EQ(mapped.size(), 0);
+
+        unlink(path);
+    }
+
+} // namespace anonymouse
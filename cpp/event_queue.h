@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <functional>
+
+// reference: http://gameprogrammingpatterns.com/event-queue.html
+
+namespace Mif {
+
+    // Fixed-capacity ring buffer of deferred (entity, event) records.
+    // push() only appends; flush() dispatches everything queued so far,
+    // grouped by event type so that each observer runs over a whole batch.
+    template <typename Entity, typename Event, uint32_t kCapacity, uint32_t kNumEvents>
+    class EventQueue {
+        static_assert((kCapacity & (kCapacity - 1)) == 0, "capacity must be a power of 2");
+
+    public:
+        struct Record {
+            Entity entity;
+            Event event;
+        };
+
+        EventQueue()
+            : m_head(0)
+            , m_tail(0)
+            , m_flushing(false)
+        {
+            ;
+        }
+
+        bool push(const Entity& entity, Event event);
+
+        // dispatch(Event event, const Record* records, uint32_t count) is called
+        // once per event type that has pending records, in event type order.
+        // Within a group records keep their push order, unless coalesce is set,
+        // in which case duplicated (entity, event) records are dispatched once.
+        // A flush() called from dispatch does nothing and returns 0: records
+        // pushed meanwhile stay queued for the next flush().
+        template <typename Dispatch>
+        uint32_t flush(Dispatch dispatch, bool coalesce = false);
+
+        void clear() { m_head = m_tail = 0; }
+
+        uint32_t size() const { return m_tail - m_head; }
+        bool empty() const { return m_head == m_tail; }
+        bool full() const { return size() == kCapacity; }
+        bool flushing() const { return m_flushing; }
+        static uint32_t capacity() { return kCapacity; }
+
+    private:
+        static const uint32_t kMask = kCapacity - 1;
+
+        Record m_ring[kCapacity];
+        Record m_sorted[kCapacity];  // scratch for grouping in flush()
+        uint32_t m_head;
+        uint32_t m_tail;
+        bool m_flushing;  // m_sorted is being dispatched
+    };
+
+
+    template <typename Entity, typename Event, uint32_t kCapacity, uint32_t kNumEvents>
+    bool EventQueue<Entity, Event, kCapacity, kNumEvents>::push(const Entity& entity, Event event)
+    {
+        assert(static_cast<uint32_t>(event) < kNumEvents && "unknown event type");
+
+        if (full())
+            return false;
+
+        Record& record = m_ring[m_tail & kMask];
+        record.entity = entity;
+        record.event = event;
+        m_tail++;
+
+        return true;
+    }
+
+
+    template <typename Entity, typename Event, uint32_t kCapacity, uint32_t kNumEvents>
+    template <typename Dispatch>
+    uint32_t EventQueue<Entity, Event, kCapacity, kNumEvents>::flush(Dispatch dispatch, bool coalesce)
+    {
+        const uint32_t count = size();
+
+        // a nested flush would overwrite m_sorted under the outer one
+        if (count == 0 || m_flushing)
+            return 0;
+
+        // counting sort by event type keeps the push order inside a group
+        uint32_t offsets[kNumEvents + 1] = {};
+
+        for (uint32_t i = m_head; i != m_tail; i++)
+        {
+            offsets[static_cast<uint32_t>(m_ring[i & kMask].event) + 1]++;
+        }
+
+        for (uint32_t e = 0; e < kNumEvents; e++)
+        {
+            offsets[e + 1] += offsets[e];
+        }
+
+        uint32_t cursor[kNumEvents];
+        std::copy(offsets, offsets + kNumEvents, cursor);
+
+        for (uint32_t i = m_head; i != m_tail; i++)
+        {
+            const Record& record = m_ring[i & kMask];
+            m_sorted[cursor[static_cast<uint32_t>(record.event)]++] = record;
+        }
+
+        // records are consumed before dispatching, so observers may push
+        // new events which will be delivered by the next flush()
+        m_head = m_tail = 0;
+        m_flushing = true;
+
+        uint32_t dispatched = 0;
+
+        for (uint32_t e = 0; e < kNumEvents; e++)
+        {
+            Record* const begin = m_sorted + offsets[e];
+            Record* end = m_sorted + offsets[e + 1];
+
+            if (begin == end)
+                continue;
+
+            if (coalesce)
+            {
+                const auto less = [](const Record& a, const Record& b) {
+                    return std::less<Entity>()(a.entity, b.entity);
+                };
+                const auto equal = [](const Record& a, const Record& b) {
+                    return a.entity == b.entity;
+                };
+
+                std::sort(begin, end, less);
+                end = std::unique(begin, end, equal);
+            }
+
+            const uint32_t n = static_cast<uint32_t>(end - begin);
+            dispatch(static_cast<Event>(e), begin, n);
+            dispatched += n;
+        }
+
+        m_flushing = false;
+
+        return dispatched;
+    }
+
+} // namespace Mif
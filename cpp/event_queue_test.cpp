@@ -0,0 +1,186 @@
+#include <cstdio>
+#include <vector>
+#include "event_queue.h"
+#include "gtest/gtest.h"
+
+namespace { // for constants
+    enum TestEvent {
+        TEST_EVENT_A = 0,
+        TEST_EVENT_B,
+        TEST_EVENT_C,
+        TEST_EVENT_NUM
+    };
+
+    const uint32_t kCapacity = 16;
+
+    typedef Mif::EventQueue<int, TestEvent, kCapacity, TEST_EVENT_NUM> Queue;
+
+    struct Batch
+    {
+        TestEvent event;
+        std::vector<int> entities;
+    };
+} // namespace anonymouse
+
+namespace { // for test fixture
+    class EventQueueTest : public ::testing::Test
+    {
+    public:
+        void SetUp();
+        void TearDown();
+
+        uint32_t flush(bool coalesce);
+
+        Queue* queue_;
+        std::vector<Batch> batches_;
+    };
+
+    void EventQueueTest::SetUp()
+    {
+        queue_ = new Queue();
+    }
+
+    void EventQueueTest::TearDown()
+    {
+        delete(queue_);
+    }
+
+    uint32_t EventQueueTest::flush(bool coalesce)
+    {
+        batches_.clear();
+
+        return queue_->flush([this](TestEvent event, const Queue::Record* records, uint32_t count) {
+            Batch batch;
+            batch.event = event;
+
+            for (uint32_t i = 0; i < count; i++)
+            {
+                EXPECT_EQ(records[i].event, event);
+                batch.entities.push_back(records[i].entity);
+            }
+
+            batches_.push_back(batch);
+        }, coalesce);
+    }
+} // namespace anonymouse
+
+
+namespace { // for functions
+
+    TEST_F(EventQueueTest, pushFull)
+    {
+        EXPECT_TRUE(queue_->empty());
+        EXPECT_EQ(Queue::capacity(), kCapacity);
+
+        for (uint32_t i = 0; i < kCapacity; i++)
+        {
+            EXPECT_TRUE(queue_->push(i, TEST_EVENT_A));
+            EXPECT_EQ(queue_->size(), i + 1);
+        }
+
+        EXPECT_TRUE(queue_->full());
+        EXPECT_FALSE(queue_->push(0, TEST_EVENT_A));
+
+        EXPECT_EQ(flush(false), kCapacity);
+        EXPECT_TRUE(queue_->empty());
+        EXPECT_EQ(flush(false), 0);
+        EXPECT_TRUE(batches_.empty());
+    }
+
+
+    TEST_F(EventQueueTest, groupByEvent)
+    {
+        queue_->push(1, TEST_EVENT_C);
+        queue_->push(2, TEST_EVENT_A);
+        queue_->push(3, TEST_EVENT_C);
+        queue_->push(4, TEST_EVENT_A);
+        queue_->push(5, TEST_EVENT_C);
+
+        EXPECT_EQ(flush(false), 5);
+        ASSERT_EQ(batches_.size(), 2);
+
+        EXPECT_EQ(batches_[0].event, TEST_EVENT_A);
+        EXPECT_EQ(batches_[0].entities, std::vector<int>({2, 4}));
+
+        EXPECT_EQ(batches_[1].event, TEST_EVENT_C);
+        EXPECT_EQ(batches_[1].entities, std::vector<int>({1, 3, 5}));
+    }
+
+
+    TEST_F(EventQueueTest, coalesce)
+    {
+        queue_->push(7, TEST_EVENT_B);
+        queue_->push(3, TEST_EVENT_B);
+        queue_->push(7, TEST_EVENT_B);
+        queue_->push(7, TEST_EVENT_A);
+        queue_->push(3, TEST_EVENT_B);
+
+        EXPECT_EQ(flush(true), 3);
+        ASSERT_EQ(batches_.size(), 2);
+
+        EXPECT_EQ(batches_[0].event, TEST_EVENT_A);
+        EXPECT_EQ(batches_[0].entities, std::vector<int>({7}));
+
+        EXPECT_EQ(batches_[1].event, TEST_EVENT_B);
+        EXPECT_EQ(batches_[1].entities, std::vector<int>({3, 7}));
+    }
+
+
+    TEST_F(EventQueueTest, pushWhileFlushing)
+    {
+        queue_->push(1, TEST_EVENT_A);
+
+        uint32_t calls = 0;
+
+        queue_->flush([this, &calls](TestEvent event, const Queue::Record* records, uint32_t /* count */) {
+            calls++;
+            queue_->push(records[0].entity + 1, event);
+        });
+
+        EXPECT_EQ(calls, 1);
+        EXPECT_EQ(queue_->size(), 1);
+
+        EXPECT_EQ(flush(false), 1);
+        EXPECT_EQ(batches_[0].entities, std::vector<int>({2}));
+    }
+
+
+    TEST_F(EventQueueTest, refillWhileFlushing)
+    {
+        queue_->push(1, TEST_EVENT_A);
+        queue_->push(2, TEST_EVENT_B);
+
+        std::vector<int> delivered;
+        uint32_t nested = ~0u;
+
+        queue_->flush([this, &delivered, &nested](TestEvent event, const Queue::Record* records, uint32_t count) {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                delivered.push_back(records[i].entity);
+            }
+
+            if (event != TEST_EVENT_A)
+                return;
+
+            // fill the queue and drain it the way a full notify() would
+            for (uint32_t i = 0; i < kCapacity; i++)
+            {
+                queue_->push(100 + i, TEST_EVENT_A);
+            }
+
+            EXPECT_TRUE(queue_->flushing());
+            EXPECT_TRUE(queue_->full());
+            nested = flush(false);
+        });
+
+        // the outer batches went out once each, the refill is still queued
+        EXPECT_EQ(nested, 0);
+        EXPECT_EQ(delivered, std::vector<int>({1, 2}));
+        EXPECT_FALSE(queue_->flushing());
+        EXPECT_EQ(queue_->size(), kCapacity);
+
+        EXPECT_EQ(flush(false), kCapacity);
+        EXPECT_EQ(batches_[0].entities.front(), 100);
+    }
+
+} // namespace anonymouse
@@ -0,0 +1,231 @@
+#include <cassert>
+#include <pthread.h>
+#include <sched.h>
+#include "executor.h"
+
+namespace Mif {
+
+    namespace {
+        const uint32_t kSpinCount = 256;   // empty polls before a worker sleeps
+
+        thread_local const Executor* t_executor = nullptr;
+        thread_local uint32_t t_index = Executor::kNoWorker;
+
+        bool pinToCpu(std::thread& thread, uint32_t cpu)
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+
+            return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+        }
+    } // namespace anonymouse
+
+
+    Executor::Executor(uint32_t numWorkers, uint32_t queueCapacity)
+    : m_nextWorker(0)
+    , m_stop(false)
+    , m_pinned(true)
+    {
+        const uint32_t numCpus = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+
+        if (numWorkers == 0)
+            numWorkers = numCpus;
+
+        for (uint32_t i = 0; i < numWorkers; i++)
+        {
+            m_workers.emplace_back(new Worker(queueCapacity));
+        }
+
+        for (uint32_t i = 0; i < numWorkers; i++)
+        {
+            m_threads.emplace_back(&Executor::run, this, i);
+
+            // more workers than CPUs share cores round-robin
+            m_pinned = pinToCpu(m_threads.back(), i % numCpus) && m_pinned;
+        }
+    }
+
+
+    Executor::~Executor()
+    {
+        m_stop.store(true, std::memory_order_seq_cst);
+
+        for (std::unique_ptr<Worker>& worker : m_workers)
+        {
+            worker->wake.fetch_add(1, std::memory_order_release);
+            worker->wake.notify_one();
+        }
+
+        for (std::thread& t : m_threads)
+        {
+            t.join();
+        }
+    }
+
+
+    void Executor::post(CallbackFunc callback, const char* arg, WaitGroup* group)
+    {
+        push(nextWorker(), Job{ nullptr, callback, const_cast<char*>(arg), group });
+    }
+
+
+    void Executor::post(uint64_t key, CallbackFunc callback, const char* arg, WaitGroup* group)
+    {
+        push(workerFor(key), Job{ nullptr, callback, const_cast<char*>(arg), group });
+    }
+
+
+    void Executor::post(TaskFunc func, void* arg, WaitGroup* group)
+    {
+        push(nextWorker(), Job{ func, nullptr, arg, group });
+    }
+
+
+    void Executor::post(uint64_t key, TaskFunc func, void* arg, WaitGroup* group)
+    {
+        push(workerFor(key), Job{ func, nullptr, arg, group });
+    }
+
+
+    void Executor::wait(WaitGroup& group) const
+    {
+        assert(t_executor != this && "a worker waiting on its own jobs would deadlock");
+
+        group.wait();
+    }
+
+
+    uint32_t Executor::workerFor(uint64_t key) const
+    {
+        // Fibonacci hashing; the top bits are the well mixed ones
+        const uint64_t hash = key * 0x9e3779b97f4a7c15ull;
+        return static_cast<uint32_t>(((hash >> 32) * numWorkers()) >> 32);
+    }
+
+
+    uint32_t Executor::currentWorker()
+    {
+        return t_index;
+    }
+
+
+    uint32_t Executor::nextWorker()
+    {
+        if (t_executor == this)
+            return t_index;
+
+        return m_nextWorker.fetch_add(1, std::memory_order_relaxed) % numWorkers();
+    }
+
+
+    void Executor::push(uint32_t index, const Job& job)
+    {
+        Worker& worker = *m_workers[index];
+
+        if (job.group)
+            job.group->add(1);
+
+        for (uint32_t spin = 0; !worker.queue.tryPush(job); spin++)
+        {
+            // Full. A worker waiting here would stop draining its own queue:
+            // posting to itself would never finish, and two workers posting
+            // to each other would deadlock. So it runs its own oldest job
+            // and tries again. The rest of the current batch is older than
+            // anything still queued, so it goes first.
+            if (t_executor == this)
+            {
+                Worker& own = *m_workers[t_index];
+                Job next;
+
+                if (own.batchNext < own.batchCount)
+                    execute(own.batch[own.batchNext++]);
+                else if (own.queue.tryPop(next))
+                    execute(next);
+
+                continue;
+            }
+
+            // the worker is busy, give it the CPU
+            if (spin >= 64)
+                std::this_thread::yield();
+        }
+
+        // pairs with the fence in run(): either the worker sees the job,
+        // or this sees that it went to sleep
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (worker.sleeping.load(std::memory_order_relaxed))
+        {
+            worker.wake.fetch_add(1, std::memory_order_release);
+            worker.wake.notify_one();
+        }
+    }
+
+
+    void Executor::execute(const Job& job)
+    {
+        if (job.task)
+            job.task(job.arg);
+        else
+            job.callback(static_cast<const char*>(job.arg));
+
+        if (job.group)
+            job.group->done();
+    }
+
+
+    void Executor::run(uint32_t index)
+    {
+        t_executor = this;
+        t_index = index;
+
+        Worker& worker = *m_workers[index];
+        uint32_t idle = 0;
+
+        for (;;)
+        {
+            uint32_t count = 0;
+
+            while (count < kBatchSize && worker.queue.tryPop(worker.batch[count]))
+            {
+                count++;
+            }
+
+            // a job may run later entries itself, see push()
+            worker.batchNext = 0;
+            worker.batchCount = count;
+
+            while (worker.batchNext < worker.batchCount)
+            {
+                execute(worker.batch[worker.batchNext++]);
+            }
+
+            if (count > 0)
+            {
+                idle = 0;
+                continue;
+            }
+
+            if (m_stop.load(std::memory_order_acquire))
+                break;
+
+            if (++idle < kSpinCount)
+                continue;
+
+            const uint32_t wake = worker.wake.load(std::memory_order_acquire);
+            worker.sleeping.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (worker.queue.size() == 0 && !m_stop.load(std::memory_order_relaxed))
+                worker.wake.wait(wake, std::memory_order_acquire);
+
+            worker.sleeping.store(false, std::memory_order_relaxed);
+            idle = 0;
+        }
+
+        t_executor = nullptr;
+        t_index = kNoWorker;
+    }
+
+} // namespace Mif
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "callback_registry.h"  // CallbackFunc
+#include "event_bus.h"          // MpmcQueue
+#include "thread_pool.h"        // TaskFunc, WaitGroup
+
+namespace Mif {
+
+    // Runs callbacks asynchronously on workers pinned to cores.
+    //
+    // Every worker owns a lock-free MpmcQueue that any thread posts to and
+    // only its worker pops from, so jobs of one queue run in the order they
+    // were posted. post() without a key spreads jobs round-robin, or keeps
+    // them on the current worker when called from one. post() with an
+    // affinity key always picks the same worker for the same key, so the
+    // data a key's callbacks touch stays in one core's cache and the
+    // callbacks never run concurrently.
+    //
+    // Workers pop up to kBatchSize jobs at a time and run them back to back.
+    // A job that posts to a full queue runs the rest of its worker's batch,
+    // then jobs of its worker's queue, until there is room, so workers never
+    // wait on each other and every queue still runs in order.
+    // There is no work stealing: it would break key affinity.
+    class Executor {
+    public:
+        static const uint32_t kBatchSize = 64;
+        static const uint32_t kNoWorker = ~0u;
+
+        // numWorkers 0: one per online CPU
+        explicit Executor(uint32_t numWorkers = 0, uint32_t queueCapacity = 4096);
+        ~Executor();  // runs everything already posted
+
+        Executor(const Executor&) = delete;
+        Executor& operator=(const Executor&) = delete;
+
+        // FUNC_POINTER style callback, called later as callback(arg)
+        void post(CallbackFunc callback, const char* arg, WaitGroup* group = nullptr);
+        void post(uint64_t key, CallbackFunc callback, const char* arg, WaitGroup* group = nullptr);
+
+        void post(TaskFunc func, void* arg, WaitGroup* group = nullptr);
+        void post(uint64_t key, TaskFunc func, void* arg, WaitGroup* group = nullptr);
+
+        // blocks until a group of posted jobs finished; jobs are never run
+        // on the caller
+        void wait(WaitGroup& group) const;
+
+        uint32_t numWorkers() const { return static_cast<uint32_t>(m_workers.size()); }
+        uint32_t workerFor(uint64_t key) const;
+        bool pinned() const { return m_pinned; }
+
+        // index of the worker running the calling thread, or kNoWorker
+        static uint32_t currentWorker();
+
+    private:
+        struct Job {
+            TaskFunc task;          // exactly one of task and callback is set
+            CallbackFunc callback;
+            void* arg;
+            WaitGroup* group;
+        };
+
+        struct Worker {
+            explicit Worker(uint32_t capacity) : queue(capacity), wake(0), sleeping(false) {}
+
+            MpmcQueue<Job> queue;
+            alignas(kCacheLineSize) std::atomic<uint32_t> wake;  // bumped to wake the worker
+            std::atomic<bool> sleeping;
+
+            // jobs popped by run() and not yet executed; only the worker
+            // touches them
+            alignas(kCacheLineSize) Job batch[kBatchSize];
+            uint32_t batchNext = 0;
+            uint32_t batchCount = 0;
+        };
+
+        void push(uint32_t index, const Job& job);
+        uint32_t nextWorker();
+        void run(uint32_t index);
+        static void execute(const Job& job);
+
+        std::vector<std::unique_ptr<Worker>> m_workers;
+        std::vector<std::thread> m_threads;
+        std::atomic<uint32_t> m_nextWorker;
+        std::atomic<bool> m_stop;
+        bool m_pinned;
+    };
+
+} // namespace Mif
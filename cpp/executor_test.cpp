@@ -0,0 +1,249 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "executor.h"
+#include "gtest/gtest.h"
+
+namespace { // for constants
+    const uint32_t kNumWorkers = 4;
+    const uint32_t kNumJobs = 100000;
+    const uint32_t kNumKeys = 16;
+} // namespace anonymouse
+
+namespace { // for test fixture
+    std::atomic<uint32_t> g_callbacks(0);
+
+    void countCallback(const char* s)
+    {
+        if (s[0] == 'x')
+            g_callbacks.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void increment(void* arg)
+    {
+        static_cast<std::atomic<uint32_t>*>(arg)->fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // written by one worker only, the one the key maps to
+    struct KeyState {
+        uint32_t worker = Mif::Executor::kNoWorker;
+        uint32_t next = 0;
+        bool inOrder = true;
+        bool sameWorker = true;
+    };
+
+    struct KeyedJob {
+        KeyState* state;
+        uint32_t sequence;
+    };
+
+    void runKeyed(void* arg)
+    {
+        const KeyedJob& job = *static_cast<KeyedJob*>(arg);
+        KeyState& state = *job.state;
+        const uint32_t worker = Mif::Executor::currentWorker();
+
+        if (state.worker == Mif::Executor::kNoWorker)
+            state.worker = worker;
+
+        state.sameWorker = state.sameWorker && state.worker == worker;
+        state.inOrder = state.inOrder && job.sequence == state.next;
+        state.next++;
+    }
+
+    // floods its own worker's queue and another worker's queue
+    struct Flood {
+        Mif::Executor* executor;
+        Mif::WaitGroup* group;
+        std::atomic<uint32_t>* count;
+        uint64_t otherKey;
+    };
+
+    const uint32_t kFloodJobs = 200;
+
+    void flood(void* arg)
+    {
+        const Flood& f = *static_cast<Flood*>(arg);
+
+        for (uint32_t i = 0; i < kFloodJobs; i++)
+        {
+            f.executor->post(increment, f.count, f.group);
+            f.executor->post(f.otherKey, increment, f.count, f.group);
+        }
+    }
+
+    // holds the only worker until released
+    struct Blocker {
+        std::atomic<bool> started{ false };
+        std::atomic<bool> released{ false };
+    };
+
+    void block(void* arg)
+    {
+        Blocker& b = *static_cast<Blocker*>(arg);
+        b.started.store(true, std::memory_order_release);
+
+        while (!b.released.load(std::memory_order_acquire))
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    // posts more keyed jobs than the queue holds, from inside a job
+    struct Poster {
+        Mif::Executor* executor;
+        Mif::WaitGroup* group;
+        KeyedJob* jobs;
+        uint32_t count;
+    };
+
+    void postKeyed(void* arg)
+    {
+        const Poster& p = *static_cast<Poster*>(arg);
+
+        for (uint32_t i = 0; i < p.count; i++)
+        {
+            p.executor->post(0, runKeyed, &p.jobs[i], p.group);
+        }
+    }
+} // namespace anonymouse
+
+
+namespace { // for functions
+
+    TEST(ExecutorTest, runsEveryJob)
+    {
+        Mif::Executor executor(kNumWorkers, 256);
+        EXPECT_EQ(executor.numWorkers(), kNumWorkers);
+
+        std::atomic<uint32_t> count(0);
+        Mif::WaitGroup group;
+
+        g_callbacks = 0;
+
+        for (uint32_t i = 0; i < kNumJobs; i++)
+        {
+            executor.post(increment, &count, &group);
+        }
+
+        executor.post(countCallback, "x", &group);
+        executor.wait(group);
+
+        EXPECT_EQ(count.load(), kNumJobs);
+        EXPECT_EQ(g_callbacks.load(), 1);
+    }
+
+
+    TEST(ExecutorTest, keyAffinityAndOrder)
+    {
+        Mif::Executor executor(kNumWorkers);
+
+        KeyState states[kNumKeys];
+        std::vector<KeyedJob> jobs(kNumJobs);
+        Mif::WaitGroup group;
+
+        for (uint32_t i = 0; i < kNumJobs; i++)
+        {
+            const uint32_t key = i % kNumKeys;
+            jobs[i] = KeyedJob{ &states[key], i / kNumKeys };
+            executor.post(key, runKeyed, &jobs[i], &group);
+        }
+
+        executor.wait(group);
+
+        for (uint32_t key = 0; key < kNumKeys; key++)
+        {
+            EXPECT_EQ(states[key].next, kNumJobs / kNumKeys);
+            EXPECT_EQ(states[key].worker, executor.workerFor(key));
+            EXPECT_TRUE(states[key].sameWorker);
+            EXPECT_TRUE(states[key].inOrder);
+        }
+    }
+
+
+    TEST(ExecutorTest, destructorDrains)
+    {
+        std::atomic<uint32_t> count(0);
+
+        {
+            Mif::Executor executor(2);
+
+            for (uint32_t i = 0; i < 1000; i++)
+            {
+                executor.post(i, increment, &count);
+            }
+        }
+
+        EXPECT_EQ(count.load(), 1000);
+    }
+
+
+    TEST(ExecutorTest, workersPostToFullQueues)
+    {
+        // queues much smaller than what the jobs post
+        Mif::Executor executor(2, 4);
+
+        uint64_t keys[2] = { 0, 0 };
+
+        while (executor.workerFor(keys[1]) == executor.workerFor(keys[0]))
+        {
+            keys[1]++;
+        }
+
+        std::atomic<uint32_t> count(0);
+        Mif::WaitGroup group;
+
+        Flood floods[2] = {
+            { &executor, &group, &count, keys[1] },
+            { &executor, &group, &count, keys[0] },
+        };
+
+        executor.post(keys[0], flood, &floods[0], &group);
+        executor.post(keys[1], flood, &floods[1], &group);
+        executor.wait(group);
+
+        EXPECT_EQ(count.load(), 2 * 2 * kFloodJobs);
+    }
+
+
+    TEST(ExecutorTest, fullQueueKeepsOrder)
+    {
+        const uint32_t kCapacity = 4;
+        Mif::Executor executor(1, kCapacity);
+
+        KeyState state;
+        std::vector<KeyedJob> jobs(kCapacity + 2 * kCapacity);
+
+        for (uint32_t i = 0; i < jobs.size(); i++)
+        {
+            jobs[i] = KeyedJob{ &state, i };
+        }
+
+        Mif::WaitGroup group;
+        Blocker blocker;
+        Poster poster = { &executor, &group, &jobs[kCapacity - 1], 2 * kCapacity + 1 };
+
+        executor.post(block, &blocker, &group);
+
+        while (!blocker.started.load(std::memory_order_acquire))
+        {
+            std::this_thread::yield();
+        }
+
+        // fills the queue, so the worker takes all of it as one batch and
+        // the poster finds the queue full while the batch is not done yet
+        executor.post(0, postKeyed, &poster, &group);
+
+        for (uint32_t i = 0; i < kCapacity - 1; i++)
+        {
+            executor.post(0, runKeyed, &jobs[i], &group);
+        }
+
+        blocker.released.store(true, std::memory_order_release);
+        executor.wait(group);
+
+        EXPECT_EQ(state.next, jobs.size());
+        EXPECT_TRUE(state.inOrder);
+    }
+
+} // namespace anonymouse
@@ -0,0 +1,307 @@
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "fd_channel.h"
+
+namespace Mif {
+
+    bool makeUnixAddress(const char* path, sockaddr_un& addr, socklen_t& length)
+    {
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+
+        const size_t n = strlen(path);
+
+        if (n >= sizeof(addr.sun_path))
+        {
+            errno = ENAMETOOLONG;
+            return false;
+        }
+
+        memcpy(addr.sun_path, path, n + 1);
+        length = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + n + 1);
+        return true;
+    }
+
+
+    void closeKeepErrno(int fd)
+    {
+        const int err = errno;
+        ::close(fd);
+        errno = err;
+    }
+
+
+    FdChannel::FdChannel()
+    : m_socket(-1)
+    {
+        ;
+    }
+
+
+    FdChannel::FdChannel(int socket)
+    : m_socket(socket)
+    {
+        ;
+    }
+
+
+    FdChannel::~FdChannel()
+    {
+        close();
+    }
+
+
+    FdChannel::FdChannel(FdChannel&& other)
+    : m_socket(other.m_socket)
+    , m_path(std::move(other.m_path))
+    {
+        other.m_socket = -1;
+        other.m_path.clear();
+    }
+
+
+    FdChannel& FdChannel::operator=(FdChannel&& other)
+    {
+        if (this != &other)
+        {
+            close();
+            m_socket = other.m_socket;
+            m_path = std::move(other.m_path);
+            other.m_socket = -1;
+            other.m_path.clear();
+        }
+
+        return *this;
+    }
+
+
+    bool FdChannel::listen(const char* path)
+    {
+        close();
+
+        sockaddr_un addr;
+        socklen_t length;
+
+        if (!makeUnixAddress(path, addr, length))
+            return false;
+
+        const int s = socket(PF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+
+        if (s < 0)
+            return false;
+
+        unlink(path);
+
+        if (bind(s, reinterpret_cast<sockaddr*>(&addr), length) < 0)
+        {
+            closeKeepErrno(s);
+            return false;
+        }
+
+        m_socket = s;
+        m_path = path;
+
+        return true;
+    }
+
+
+    bool FdChannel::connect(const char* path)
+    {
+        close();
+
+        sockaddr_un addr;
+        socklen_t length;
+
+        if (!makeUnixAddress(path, addr, length))
+            return false;
+
+        const int s = socket(PF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+
+        if (s < 0)
+            return false;
+
+        if (::connect(s, reinterpret_cast<sockaddr*>(&addr), length) < 0)
+        {
+            closeKeepErrno(s);
+            return false;
+        }
+
+        m_socket = s;
+
+        return true;
+    }
+
+
+    bool FdChannel::pair(FdChannel& a, FdChannel& b)
+    {
+        int sockets[2];
+
+        if (socketpair(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0, sockets) < 0)
+            return false;
+
+        a = FdChannel(sockets[0]);
+        b = FdChannel(sockets[1]);
+
+        return true;
+    }
+
+
+    bool FdChannel::sendFd(int fd, const void* message, size_t length)
+    {
+        return sendFds(&fd, 1, message, length);
+    }
+
+
+    int FdChannel::recvFd(void* message, size_t size, size_t* length)
+    {
+        int fd;
+        const int count = recvFds(&fd, 1, message, size, length);
+
+        if (count < 0)
+            return -1;
+
+        if (count == 0)
+        {
+            errno = EBADMSG;
+            return -1;
+        }
+
+        return fd;
+    }
+
+
+    bool FdChannel::sendFds(const int* fds, uint32_t count, const void* message, size_t length)
+    {
+        if (count == 0 || count > kMaxFdsPerMessage)
+        {
+            errno = EINVAL;
+            return false;
+        }
+
+        iovec iov;
+        iov.iov_base = const_cast<void*>(message);
+        iov.iov_len = length;
+
+        // a union keeps the control buffer aligned for cmsghdr
+        union {
+            char buf[CMSG_SPACE(kMaxFdsPerMessage * sizeof(int))];
+            cmsghdr align;
+        } control;
+
+        const size_t fdBytes = count * sizeof(int);
+        memset(control.buf, 0, CMSG_SPACE(fdBytes));
+
+        msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.buf;
+        msg.msg_controllen = CMSG_SPACE(fdBytes);
+
+        cmsghdr* const cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_len = CMSG_LEN(fdBytes);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        memcpy(CMSG_DATA(cmsg), fds, fdBytes);
+
+        ssize_t n;
+
+        do {
+            n = sendmsg(m_socket, &msg, MSG_NOSIGNAL);
+        } while (n < 0 && errno == EINTR);
+
+        return n >= 0;
+    }
+
+
+    int FdChannel::recvFds(int* fds, uint32_t maxFds, void* message, size_t size, size_t* length)
+    {
+        iovec iov;
+        iov.iov_base = message;
+        iov.iov_len = size;
+
+        // room for a full message, so the kernel never has to drop any
+        union {
+            char buf[CMSG_SPACE(kMaxFdsPerMessage * sizeof(int))];
+            cmsghdr align;
+        } control;
+
+        msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.buf;
+        msg.msg_controllen = sizeof(control.buf);
+
+        ssize_t n;
+
+        do {
+            n = recvmsg(m_socket, &msg, MSG_CMSG_CLOEXEC);
+        } while (n < 0 && errno == EINTR);
+
+        if (n < 0)
+            return -1;
+
+        if (length)
+            *length = static_cast<size_t>(n);
+
+        uint32_t count = 0;
+        bool overflow = (msg.msg_flags & MSG_CTRUNC) != 0;
+
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg))
+        {
+            if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+                continue;
+
+            const size_t numFds = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            const unsigned char* data = CMSG_DATA(cmsg);
+
+            for (size_t i = 0; i < numFds; i++)
+            {
+                int fd;
+                memcpy(&fd, data + i * sizeof(int), sizeof(int));
+
+                if (count < maxFds)
+                {
+                    fds[count++] = fd;
+                }
+                else
+                {
+                    ::close(fd);
+                    overflow = true;
+                }
+            }
+        }
+
+        if (overflow)
+        {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                ::close(fds[i]);
+            }
+
+            errno = EMSGSIZE;
+            return -1;
+        }
+
+        return static_cast<int>(count);
+    }
+
+
+    void FdChannel::close()
+    {
+        if (m_socket >= 0)
+            ::close(m_socket);
+
+        if (!m_path.empty())
+            unlink(m_path.c_str());
+
+        m_socket = -1;
+        m_path.clear();
+    }
+
+} // namespace Mif
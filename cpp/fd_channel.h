@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// File descriptor passing over PF_UNIX datagram sockets (SCM_RIGHTS), as a
+// library: socket_sendfd.cpp and socket_recvfd.cpp are thin programs on top
+// of it.
+//
+// Nothing here exits or logs. Failures return false or -1 with errno set,
+// so a long-running server can retry or give up on one peer.
+
+namespace Mif {
+
+    // fills addr for a PF_UNIX socket at path. Unlike strlcpy(), which glibc
+    // lacks anyway, a path that does not fit is an error (ENAMETOOLONG)
+    // rather than silently truncated.
+    bool makeUnixAddress(const char* path, sockaddr_un& addr, socklen_t& length);
+
+    // close() for cleanup on an error path: keeps the errno being reported
+    void closeKeepErrno(int fd);
+
+    class FdChannel {
+    public:
+        // SCM_MAX_FD: the kernel's limit of descriptors in one message
+        static const uint32_t kMaxFdsPerMessage = 253;
+
+        FdChannel();
+        explicit FdChannel(int socket);  // adopts a connected socket
+        ~FdChannel();
+
+        FdChannel(FdChannel&& other);
+        FdChannel& operator=(FdChannel&& other);
+
+        FdChannel(const FdChannel&) = delete;
+        FdChannel& operator=(const FdChannel&) = delete;
+
+        // receiving end: binds path, replacing a stale socket file; the file
+        // is removed again by close()
+        bool listen(const char* path);
+
+        // sending end: connects to a listening channel at path
+        bool connect(const char* path);
+
+        // a connected pair in this process, e.g. to hand one end to a child
+        static bool pair(FdChannel& a, FdChannel& b);
+
+        // sends fd along with message (at least one byte); the receiver gets
+        // its own descriptor for the same file. false with errno on failure.
+        bool sendFd(int fd, const void* message, size_t length);
+
+        // receives a message into message and returns the fd that came with
+        // it; -1 with errno on failure, EBADMSG if the message had no fd.
+        // length, if not null, is set to the number of message bytes.
+        int recvFd(void* message, size_t size, size_t* length = nullptr);
+
+        // sends up to kMaxFdsPerMessage descriptors in a single message, so
+        // handing off many costs one syscall instead of one per descriptor
+        bool sendFds(const int* fds, uint32_t count, const void* message, size_t length);
+
+        // receives one message and stores its descriptors, from every
+        // control message it carries, in fds. Returns their number, which
+        // may be 0, or -1 with errno; EMSGSIZE if more than maxFds arrived,
+        // in which case none of them is kept open.
+        int recvFds(int* fds, uint32_t maxFds, void* message, size_t size, size_t* length = nullptr);
+
+        void close();
+
+        int fd() const { return m_socket; }
+        bool isOpen() const { return m_socket >= 0; }
+
+    private:
+        int m_socket;
+        std::string m_path;  // bound by listen(), unlinked by close()
+    };
+
+} // namespace Mif
@@ -0,0 +1,107 @@
+#include <cstdio>
+#include <cstdint>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+#include "fd_channel.h"
+
+using namespace std;
+
+// Descriptors per second through a Mif::FdChannel socketpair: one thread
+// sends the same descriptor over and over, the other receives and closes
+// each copy. Messages carry 1, 16 or kMaxFdsPerMessage descriptors.
+
+#define VPRINTF(...) \
+    do { \
+        printf(__VA_ARGS__); \
+    } while (false)
+
+namespace {
+
+    const uint32_t kNumFds = 200 * 1000;
+
+    // sends kNumFds copies of fd, batch per message; returns fds per second
+    double bench(int fd, uint32_t batch)
+    {
+        Mif::FdChannel sender, receiver;
+
+        if (!Mif::FdChannel::pair(sender, receiver))
+        {
+            perror("socketpair");
+            return 0;
+        }
+
+        const auto start = chrono::steady_clock::now();
+
+        thread producer([&sender, fd, batch]() {
+            int fds[Mif::FdChannel::kMaxFdsPerMessage];
+
+            for (uint32_t i = 0; i < batch; i++)
+            {
+                fds[i] = fd;
+            }
+
+            for (uint32_t sent = 0; sent < kNumFds; sent += batch)
+            {
+                const uint32_t count = min(batch, kNumFds - sent);
+
+                if (!sender.sendFds(fds, count, &sent, sizeof(sent)))
+                {
+                    perror("sendFds");
+                    break;
+                }
+            }
+        });
+
+        uint32_t received = 0;
+        int fds[Mif::FdChannel::kMaxFdsPerMessage];
+
+        while (received < kNumFds)
+        {
+            uint32_t sequence;
+            const int count = receiver.recvFds(fds, Mif::FdChannel::kMaxFdsPerMessage, &sequence, sizeof(sequence));
+
+            if (count < 0)
+            {
+                perror("recvFds");
+                break;
+            }
+
+            for (int i = 0; i < count; i++)
+            {
+                close(fds[i]);
+            }
+
+            received += count;
+        }
+
+        producer.join();
+
+        const chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+        return received / elapsed.count();
+    }
+
+} // namespace anonymouse
+
+
+int main()
+{
+    const int fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+
+    VPRINTF("%u fds\n", kNumFds);
+
+    const uint32_t batches[] = { 1, 16, Mif::FdChannel::kMaxFdsPerMessage };
+
+    for (uint32_t batch : batches)
+    {
+        const double rate = bench(fd, batch);
+        VPRINTF("%3u fds per message %14.0f fds/s %8.0f ns/fd\n", batch, rate, 1e9 / rate);
+    }
+
+    close(fd);
+
+    return 0;
+}
@@ -0,0 +1,199 @@
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/socket.h>
+#include "fd_channel.h"
+#include "gtest/gtest.h"
+
+namespace { // for constants
+    const uint32_t kMaxFds = Mif::FdChannel::kMaxFdsPerMessage;
+} // namespace anonymouse
+
+namespace { // for test fixture
+    class FdChannelTest : public ::testing::Test
+    {
+    public:
+        void SetUp()
+        {
+            ASSERT_TRUE(Mif::FdChannel::pair(sender_, receiver_));
+            ASSERT_EQ(pipe(pipe_), 0);
+        }
+
+        void TearDown()
+        {
+            close(pipe_[0]);
+            close(pipe_[1]);
+        }
+
+        // descriptors this process has open
+        static uint32_t numOpenFds()
+        {
+            DIR* const dir = opendir("/proc/self/fd");
+            uint32_t count = 0;
+
+            while (readdir(dir) != nullptr)
+            {
+                count++;
+            }
+
+            closedir(dir);
+            return count;
+        }
+
+        Mif::FdChannel sender_;
+        Mif::FdChannel receiver_;
+        int pipe_[2];
+    };
+} // namespace anonymouse
+
+
+namespace { // for functions
+
+    TEST_F(FdChannelTest, passesDescriptor)
+    {
+        const pid_t pid = getpid();
+        ASSERT_TRUE(sender_.sendFd(pipe_[1], &pid, sizeof(pid)));
+
+        pid_t message = 0;
+        size_t length = 0;
+        const int fd = receiver_.recvFd(&message, sizeof(message), &length);
+
+        ASSERT_GE(fd, 0);
+        EXPECT_NE(fd, pipe_[1]);
+        EXPECT_EQ(message, pid);
+        EXPECT_EQ(length, sizeof(pid));
+
+        // the received descriptor writes into the same pipe
+        ASSERT_EQ(write(fd, "abc", 3), 3);
+        close(fd);
+
+        char buf[4] = {};
+        EXPECT_EQ(read(pipe_[0], buf, sizeof(buf)), 3);
+        EXPECT_STREQ(buf, "abc");
+    }
+
+
+    TEST_F(FdChannelTest, errorsInsteadOfExit)
+    {
+        // a message without a descriptor
+        ASSERT_EQ(send(sender_.fd(), "x", 1, 0), 1);
+
+        char c;
+        EXPECT_EQ(receiver_.recvFd(&c, 1), -1);
+        EXPECT_EQ(errno, EBADMSG);
+
+        EXPECT_FALSE(sender_.sendFd(-1, "x", 1));
+        EXPECT_EQ(errno, EBADF);
+
+        Mif::FdChannel channel;
+        EXPECT_FALSE(channel.connect("/tmp/fd_channel_test_nobody_listens"));
+        EXPECT_EQ(errno, ENOENT);
+
+        const std::string longPath(200, 'a');
+        EXPECT_FALSE(channel.listen(longPath.c_str()));
+        EXPECT_EQ(errno, ENAMETOOLONG);
+        EXPECT_FALSE(channel.isOpen());
+
+        // the peer is gone
+        receiver_.close();
+        EXPECT_FALSE(sender_.sendFd(pipe_[1], "x", 1));
+    }
+
+
+    TEST_F(FdChannelTest, listenAndConnect)
+    {
+        const std::string path = "/tmp/fd_channel_test_" + std::to_string(getpid());
+
+        Mif::FdChannel server;
+        ASSERT_TRUE(server.listen(path.c_str()));
+        EXPECT_EQ(access(path.c_str(), F_OK), 0);
+
+        Mif::FdChannel client;
+        ASSERT_TRUE(client.connect(path.c_str()));
+        ASSERT_TRUE(client.sendFd(pipe_[1], "m", 1));
+
+        char c = 0;
+        const int fd = server.recvFd(&c, 1);
+        EXPECT_GE(fd, 0);
+        EXPECT_EQ(c, 'm');
+        close(fd);
+
+        // moving keeps a single owner of the socket file
+        Mif::FdChannel moved(std::move(server));
+        EXPECT_FALSE(server.isOpen());
+        EXPECT_TRUE(moved.isOpen());
+
+        moved.close();
+        EXPECT_NE(access(path.c_str(), F_OK), 0);
+    }
+
+
+    TEST_F(FdChannelTest, fullBatchInOneMessage)
+    {
+        int fds[kMaxFds];
+
+        for (uint32_t i = 0; i < kMaxFds; i++)
+        {
+            fds[i] = (i % 2) ? pipe_[1] : pipe_[0];
+        }
+
+        const uint32_t before = numOpenFds();
+        ASSERT_TRUE(sender_.sendFds(fds, kMaxFds, "batch", 5));
+
+        int received[kMaxFds];
+        char message[8] = {};
+        size_t length = 0;
+        ASSERT_EQ(receiver_.recvFds(received, kMaxFds, message, sizeof(message), &length), static_cast<int>(kMaxFds));
+        EXPECT_EQ(length, 5);
+        EXPECT_STREQ(message, "batch");
+        EXPECT_EQ(numOpenFds(), before + kMaxFds);
+
+        // order is kept: odd ones are write ends
+        ASSERT_EQ(write(received[1], "z", 1), 1);
+
+        char c = 0;
+        EXPECT_EQ(read(pipe_[0], &c, 1), 1);
+        EXPECT_EQ(c, 'z');
+
+        for (uint32_t i = 0; i < kMaxFds; i++)
+        {
+            close(received[i]);
+        }
+
+        EXPECT_EQ(numOpenFds(), before);
+    }
+
+
+    TEST_F(FdChannelTest, batchLimits)
+    {
+        int fds[kMaxFds + 1];
+
+        for (uint32_t i = 0; i <= kMaxFds; i++)
+        {
+            fds[i] = pipe_[1];
+        }
+
+        EXPECT_FALSE(sender_.sendFds(fds, kMaxFds + 1, "x", 1));
+        EXPECT_EQ(errno, EINVAL);
+        EXPECT_FALSE(sender_.sendFds(fds, 0, "x", 1));
+        EXPECT_EQ(errno, EINVAL);
+
+        // more than the caller has room for: none is leaked
+        const uint32_t before = numOpenFds();
+        ASSERT_TRUE(sender_.sendFds(fds, 3, "x", 1));
+
+        int received[2];
+        char c;
+        EXPECT_EQ(receiver_.recvFds(received, 2, &c, 1), -1);
+        EXPECT_EQ(errno, EMSGSIZE);
+        EXPECT_EQ(numOpenFds(), before);
+
+        // a message without descriptors is not an error here
+        ASSERT_EQ(send(sender_.fd(), "y", 1, 0), 1);
+        EXPECT_EQ(receiver_.recvFds(received, 2, &c, 1), 0);
+        EXPECT_EQ(c, 'y');
+    }
+
+} // namespace anonymouse
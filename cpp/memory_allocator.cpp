@@ -1,6 +1,7 @@
 #include <cstdio>
 #include <cstdint>
 #include <cassert>
+#include <cstdlib>
 #include "memory_allocator.h"
 
 namespace Mif {
@@ -30,4 +31,82 @@ namespace Mif {
         return reinterpret_cast<void*>(aligned_address);
     }
 
+
+    void StackAllocator::freeToMarker(void* marker)
+    {
+        const uintptr_t address = reinterpret_cast<uintptr_t>(marker);
+
+        assert(m_start <= address && address <= m_current && "marker is not inside the allocated range");
+
+        m_current = address;
+    }
+
+
+
+    PoolAllocator::PoolAllocator(size_t blockSize, uint32_t blocksPerChunk)
+    : m_blockSize(((blockSize < sizeof(FreeBlock) ? sizeof(FreeBlock) : blockSize) + 15) & ~static_cast<size_t>(15))
+    , m_blocksPerChunk(blocksPerChunk)
+    , m_freeList(nullptr)
+    , m_numAllocated(0)
+    {
+        assert(blocksPerChunk > 0 && "chunk must hold at least one block");
+    }
+
+
+    PoolAllocator::~PoolAllocator()
+    {
+        for (void* chunk : m_chunks)
+        {
+            std::free(chunk);
+        }
+    }
+
+
+    void* PoolAllocator::alloc()
+    {
+        if (m_freeList == nullptr)
+            grow();
+
+        FreeBlock* const block = m_freeList;
+        m_freeList = block->next;
+        m_numAllocated++;
+
+        return block;
+    }
+
+
+    void PoolAllocator::free(void* block)
+    {
+        if (block == nullptr)
+            return;
+
+        assert(m_numAllocated > 0 && "freeing more blocks than allocated");
+
+        FreeBlock* const freed = static_cast<FreeBlock*>(block);
+        freed->next = m_freeList;
+        m_freeList = freed;
+        m_numAllocated--;
+    }
+
+
+    void PoolAllocator::grow()
+    {
+        void* chunk = nullptr;
+
+        if (posix_memalign(&chunk, 16, m_blockSize * m_blocksPerChunk) != 0)
+            throw std::bad_alloc();
+
+        m_chunks.push_back(chunk);
+
+        // thread the new blocks onto the free list, lowest address first
+        char* const base = static_cast<char*>(chunk);
+
+        for (uint32_t i = m_blocksPerChunk; i > 0; i--)
+        {
+            FreeBlock* const block = reinterpret_cast<FreeBlock*>(base + (i - 1) * m_blockSize);
+            block->next = m_freeList;
+            m_freeList = block;
+        }
+    }
+
 } // namespace Mif
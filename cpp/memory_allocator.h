@@ -1,16 +1,35 @@
+#pragma once
+
 #include <cstdio>
 #include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
 
 // reference: http://www.swedishcoding.com/2008/08/31/are-we-out-of-memory/
 
 namespace Mif {
 
+    // smallest power of 2 >= n, e.g. to size a ring indexed with a mask
+    inline uint32_t roundUpPow2(uint32_t n)
+    {
+        uint32_t p = 1;
+
+        while (p < n)
+        {
+            p <<= 1;
+        }
+
+        return p;
+    }
+
+
     class StackAllocator {
     public:
         StackAllocator(void* start, size_t size);
 
         void* alloc(size_t size, size_t align);
-        //void freeToMarker(void* marker);
+        void freeToMarker(void* marker);  // marker: an earlier getCurrent()
         void reset() { m_current = m_start; };
 
         void* getStart() { return reinterpret_cast<void*>(m_start); }
@@ -26,4 +45,72 @@ namespace Mif {
 
     };
 
+
+    // Fixed-size block allocator: O(1) alloc/free from an intrusive free
+    // list, growing by whole chunks. Blocks are 16-byte aligned and are only
+    // returned to the system when the allocator is destroyed.
+    class PoolAllocator {
+    public:
+        PoolAllocator(size_t blockSize, uint32_t blocksPerChunk = 256);
+        ~PoolAllocator();
+
+        PoolAllocator(const PoolAllocator&) = delete;
+        PoolAllocator& operator=(const PoolAllocator&) = delete;
+
+        void* alloc();
+        void free(void* block);
+
+        size_t getBlockSize() const { return m_blockSize; }
+        uint32_t getNumAllocated() const { return m_numAllocated; }
+        uint32_t getNumChunks() const { return static_cast<uint32_t>(m_chunks.size()); }
+
+    private:
+        struct FreeBlock {
+            FreeBlock* next;
+        };
+
+        void grow();
+
+        const size_t m_blockSize;
+        const uint32_t m_blocksPerChunk;
+        FreeBlock* m_freeList;
+        std::vector<void*> m_chunks;
+        uint32_t m_numAllocated;
+    };
+
+
+    // STL allocator returning kAlignment-aligned blocks, e.g. for arrays
+    // walked by SIMD kernels, or to keep arrays on separate cache lines.
+    template <typename T, size_t kAlignment = 64>
+    class AlignedAllocator {
+    public:
+        typedef T value_type;
+
+        template <typename U>
+        struct rebind { typedef AlignedAllocator<U, kAlignment> other; };
+
+        AlignedAllocator() {}
+
+        template <typename U>
+        AlignedAllocator(const AlignedAllocator<U, kAlignment>&) {}
+
+        T* allocate(size_t n)
+        {
+            void* p = nullptr;
+
+            if (posix_memalign(&p, kAlignment, n * sizeof(T)) != 0)
+                throw std::bad_alloc();
+
+            return static_cast<T*>(p);
+        }
+
+        void deallocate(T* p, size_t) { free(p); }
+
+        template <typename U>
+        bool operator==(const AlignedAllocator<U, kAlignment>&) const { return true; }
+
+        template <typename U>
+        bool operator!=(const AlignedAllocator<U, kAlignment>&) const { return false; }
+    };
+
 } // namespace Mif
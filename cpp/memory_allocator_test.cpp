@@ -1,4 +1,6 @@
 #include <cstdio>
+#include <cstring>
+#include <vector>
 #include "memory_allocator.h"
 #include "gtest/gtest.h"
 
@@ -264,6 +266,69 @@ namespace { // for functions
         }
     }
 
+
+
+    TEST(AlignedAllocatorTest, alignment)
+    {
+        std::vector<uint8_t, Mif::AlignedAllocator<uint8_t, 64>> bytes;
+        std::vector<double, Mif::AlignedAllocator<double, 256>> doubles;
+
+        for (uint32_t i = 0; i < 100; ++i)
+        {
+            bytes.push_back(i);
+            doubles.push_back(i);
+
+            EXPECT_EQ((uintptr_t)bytes.data() % 64, 0);
+            EXPECT_EQ((uintptr_t)doubles.data() % 256, 0);
+        }
+
+        EXPECT_EQ(bytes[99], 99);
+        EXPECT_EQ(doubles[99], 99.0);
+    }
+
+
+    TEST(PoolAllocatorTest, allocFree)
+    {
+        Mif::PoolAllocator pool(40, 8);
+
+        EXPECT_EQ(pool.getBlockSize(), 48);  // rounded up to 16
+        EXPECT_EQ(pool.getNumChunks(), 0);
+
+        std::vector<void*> blocks;
+
+        for (uint32_t i = 0; i < 20; ++i)
+        {
+            void* const block = pool.alloc();
+            EXPECT_EQ((uintptr_t)block % 16, 0);
+            memset(block, 0xff, pool.getBlockSize());
+            blocks.push_back(block);
+        }
+
+        EXPECT_EQ(pool.getNumAllocated(), 20);
+        EXPECT_EQ(pool.getNumChunks(), 3);
+
+        // the most recently freed block is handed out first
+        pool.free(blocks[5]);
+        pool.free(blocks[7]);
+        EXPECT_EQ(pool.alloc(), blocks[7]);
+        EXPECT_EQ(pool.alloc(), blocks[5]);
+
+        for (void* block : blocks)
+        {
+            pool.free(block);
+        }
+
+        EXPECT_EQ(pool.getNumAllocated(), 0);
+
+        // freed blocks are reused before growing again
+        for (uint32_t i = 0; i < 24; ++i)
+        {
+            pool.alloc();
+        }
+
+        EXPECT_EQ(pool.getNumChunks(), 3);
+    }
+
 } // namespace anonymouse
 
 
@@ -1,41 +1,137 @@
 #include<cstdint>
 #include<cstdio>
 #include<cassert>
+#include<cstring>
 #include<memory>
+#include<vector>
+#include<thread>
+#include<atomic>
+#include "event_queue.h"
+#include "event_bus.h"
+#include "thread_pool.h"
+#include "delegate.h"
+#include "static_subject.h"
+#include "entity_store.h"
+#include "surface_grid.h"
+#include "slot_map.h"
+#include "achievement_engine.h"
+#include "event_journal.h"
+#include "binary_log.h"
+#include "dispatch_stats.h"
+#include "event_awaiter.h"
+#include "event_fanout.h"
 
 using namespace std;
 
-#define VSPRINTF(...) \
-    do { \
-        printf("L%d %s(): ", __LINE__, __func__); \
-        printf(__VA_ARGS__); \
-    } while (false);\
+// formatted on the logger thread; see binary_log.h
+#define VSPRINTF(...) MIF_LOG(INFO, __VA_ARGS__)
 
+static const float kTimeStep = 1.0f / 60.0f;
+
+/*
+   Entity keeps its own state; Mif::EntityStore runs the same
+   accelerate()/update() over many entities at once
+*/
 class Entity {
 public:
     Entity(int id)
         : id_(id)
+        , posX_(0.0f)
+        , posY_(0.0f)
+        , velX_(0.0f)
+        , velY_(0.0f)
+        , floor_(0.0f)
+    {
+        MIF_LOG(DEBUG, "new entity created (%d)\n", id_);
+    }
+
+    // entities live in a Mif::SlotMap, which moves them around
+    Entity(Entity&& other)
+        : id_(other.id_)
+        , posX_(other.posX_)
+        , posY_(other.posY_)
+        , velX_(other.velX_)
+        , velY_(other.velY_)
+        , floor_(other.floor_)
     {
-        VSPRINTF("new entity created (%d)\n", id_);
+        other.id_ = kMovedFrom;
     }
 
+    Entity(const Entity&) = delete;
+    Entity& operator=(const Entity&) = delete;
+
     ~Entity()
     {
-        VSPRINTF("entity %d destroyed\n", id_);
+        if (id_ != kMovedFrom)
+            MIF_LOG(DEBUG, "entity %d destroyed\n", id_);
     }
 
+    int id() const { return id_; }
+
     bool isOnSurface() const;
     void accelerate(int a);
     void update();
 
+    void moveTo(float x, float y) { posX_ = x; posY_ = y; }
+    void setVelocityX(float vx) { velX_ = vx; }
+    // height of the surface below, see Mif::SurfaceGrid::floorAt()
+    void setFloor(float floor) { floor_ = floor; }
+
+    float posX() const { return posX_; }
+    float posY() const { return posY_; }
+
 private:
+    static const int kMovedFrom = -1;
+
     int id_;
+    float posX_;
+    float posY_;
+    float velX_;
+    float velY_;
+    float floor_;
 };
 
+bool Entity::isOnSurface() const
+{
+    return posY_ <= floor_;
+}
+
+void Entity::accelerate(int a)
+{
+    velY_ += a * kTimeStep;
+}
+
+void Entity::update()
+{
+    posX_ += velX_ * kTimeStep;
+    posY_ += velY_ * kTimeStep;
+
+    if (posY_ <= floor_)
+    {
+        posY_ = floor_;
+        velY_ = max(velY_, 0.0f);
+    }
+}
+
+/*
+   all entities are owned here; everything else refers to them by handle,
+   which stays safe to keep in queues after the entity is gone. the handle value
+   may be passed to other threads, but the SlotMap has no locking of its own:
+   lookups in entities() need external synchronization
+*/
+typedef Mif::Handle EntityHandle;
+
+Mif::SlotMap<Entity>& entities()
+{
+    static Mif::SlotMap<Entity> entities;
+    return entities;
+}
+
 
 enum Event {
     EVENT_ENTITY_FELL = 0,
     // ...
+    EVENT_NUM
 };
 
 /***************************************************************/
@@ -44,8 +140,24 @@ class Observer
 {
 public:
     virtual ~Observer() {}
-    virtual void onNotify(const Entity& entity,
+    virtual void onNotify(EntityHandle entity,
             Event event) = 0;
+
+    // true if onNotify() may run on a pool thread concurrently
+    // with the other observers of the same subject
+    virtual bool isParallelSafe() const { return false; }
+
+    // observers that consume events return true here, once, when added;
+    // they are then called through onNotifyConsume() instead of onNotify()
+    virtual bool canConsume() const { return false; }
+
+    // returns true to consume the event: observers ordered after this one
+    // do not see it
+    virtual bool onNotifyConsume(EntityHandle entity, Event event)
+    {
+        onNotify(entity, event);
+        return false;
+    }
 };
 
 /***************************************************************/
@@ -56,75 +168,292 @@ public:
 class Achievement : public Observer
 {
 public:
-    Achievement()
+    // with an engine, events count towards its achievements, keyed by
+    // the entity's slot
+    explicit Achievement(Mif::AchievementEngine* engine = nullptr)
         : heroIsOnBride_(false)
+        , engine_(engine)
     {}
 
-    virtual void onNotify(const Entity& entity,
+    virtual void onNotify(EntityHandle entity,
             Event event);
 
+    // the engine keeps per-player state without locking
+    virtual bool isParallelSafe() const { return engine_ == nullptr; }
+
     void setHeroIsOnBridge(bool en) { heroIsOnBride_ = en; }
 
 private:
-    void unlock(Achievement achievement);
+    void unlock(EntityHandle entity, Mif::AchievementId achievement);
 
     bool heroIsOnBride_;
+    Mif::AchievementEngine* engine_;
+    std::vector<Mif::Unlock> unlocks_;
 };
 
-void Achievement::onNotify(const Entity& entity, Event event)
+void Achievement::onNotify(EntityHandle entity, Event event)
 {
     switch (event)
     {
     case EVENT_ENTITY_FELL:
-        printf("EVENT_ENTITY_FELL called\n");
+        MIF_LOG(DEBUG, "EVENT_ENTITY_FELL called\n");
         break;
 
     default:
         break;
     }
+
+    if (engine_ == nullptr || entity.index() >= engine_->numPlayers())
+        return;
+
+    const Mif::PlayerEvent playerEvent = { entity.index(), static_cast<uint32_t>(event), 1 };
+    engine_->record(playerEvent, &unlocks_);
+
+    for (const Mif::Unlock& u : unlocks_)
+    {
+        unlock(entity, u.achievement);
+    }
+
+    unlocks_.clear();
 }
 
-void Achievement::unlock(Achievement achievement)
+void Achievement::unlock(EntityHandle entity, Mif::AchievementId achievement)
 {
+    MIF_LOG(INFO, "entity %u unlocked achievement %u\n", entity.index(), achievement);
 }
 
 /***************************************************************/
+/*
+   Shield swallows falls while it is up; added in the PRE phase,
+   so no other observer hears about them
+*/
 
-class Subject
+class Shield : public Observer
 {
 public:
-    Subject()
-        : numObservers_(0)
+    Shield()
+        : up_(false)
+    {}
+
+    virtual void onNotify(EntityHandle entity, Event event) { onNotifyConsume(entity, event); }
+    virtual bool canConsume() const { return true; }
+
+    virtual bool onNotifyConsume(EntityHandle, Event event)
+    {
+        return up_ && event == EVENT_ENTITY_FELL;
+    }
+
+    void setUp(bool up) { up_ = up; }
+
+private:
+    bool up_;
+};
+
+/***************************************************************/
+/*
+   RemoteObserver forwards events to observers in other processes;
+   they go out in batches on flush()
+*/
+
+class RemoteObserver : public Observer
+{
+public:
+    explicit RemoteObserver(Mif::EventPublisher& publisher)
+        : publisher_(publisher)
+    {}
+
+    virtual void onNotify(EntityHandle entity, Event event)
+    {
+        publisher_.publish(entity.bits(), event);
+    }
+
+    void flush() { publisher_.flush(); }
+
+private:
+    Mif::EventPublisher& publisher_;
+};
+
+/***************************************************************/
+/*
+   StaticAchievement is Achievement for StaticSubject:
+   the event is a template parameter, so the switch is resolved at compile time
+*/
+
+class StaticAchievement
+{
+public:
+    StaticAchievement()
+        : numFalls_(0)
+    {}
+
+    template <Event event>
+    void onNotify(EntityHandle)
     {
-        for (int i = 0; i < kMaxObservers; i++)
+        if constexpr (event == EVENT_ENTITY_FELL)
         {
-            observers_[i] = nullptr;
+            numFalls_++;
         }
+    }
+
+    int numFalls() const { return numFalls_; }
+
+private:
+    int numFalls_;
+};
+
+/***************************************************************/
+
+enum class DispatchMode {
+    IMMEDIATE,  // notify() calls observers right away
+    QUEUED,     // notify() records the event, flush() calls observers
+    BUS,        // notify() publishes the event to an EventBus
+};
+
+struct EventRecord
+{
+    EntityHandle entity;
+    Event event;
+};
+
+typedef Mif::EventBus<EventRecord> EventBus;
+
+// lambda/functor alternative to subclassing Observer
+typedef Mif::Delegate<void(EntityHandle, Event)> ObserverDelegate;
 
+// observers run phase by phase, higher priority first within a phase,
+// in the order they were added for equal priorities; delegates run last
+enum class ObserverPhase : uint8_t {
+    PRE,
+    MAIN,
+    POST,
+};
+
+
+class Subject
+{
+public:
+    static const int kMaxObservers = 10;
+
+    typedef Mif::EventAwaiters<EntityHandle, Event, EVENT_NUM> EventAwaiters;
+
+    Subject()
+        : numObservers_(0)
+        , numConsumers_(0)
+        , numDelegates_(0)
+        , mode_(DispatchMode::IMMEDIATE)
+        , bus_(nullptr)
+        , pool_(nullptr)
+        , journal_(nullptr)
+#if MIF_DISPATCH_STATS
+        , stats_(nullptr)
+#endif
+    {
         createEntity();
     }
 
     ~Subject()
     {
-        assert(entity_);
-        delete (entity_);
+        entities().erase(entity_);
     }
 
-    void addObserver(Observer* observer);
+    void addObserver(Observer* observer, ObserverPhase phase = ObserverPhase::MAIN, int priority = 0);
     void removeObserver(const Observer* observer);
+
+    // returns an id for removeObserver(int)
+    int addObserver(const ObserverDelegate& delegate);
+    void removeObserver(int id);
     void fall();
 
+    // moves the entity one tick and calls fall() when it leaves a surface
+    void update(const Mif::SurfaceGrid& surfaces);
+
+    // the reference is invalidated when entities are created or destroyed
+    Entity& entity() { return entities()[entity_]; }
+    EntityHandle entityHandle() const { return entity_; }
+
+    void setDispatchMode(DispatchMode mode);
+    void flush(bool coalesce = false);
+
+    // thread-safe publishing target for DispatchMode::BUS
+    void setEventBus(EventBus* bus) { bus_ = bus; }
+
+    // parallel-safe observers are run on the pool, the caller waits for them
+    void setThreadPool(Mif::ThreadPool* pool) { pool_ = pool; }
+
+    // every notified event is recorded into the journal, if one is set
+    void setJournal(Mif::EventJournal* journal) { journal_ = journal; }
+
+    // co_await subject.next(event) suspends a Mif::Script until the event
+    // is dispatched, after the observers have run
+    EventAwaiters::Awaiter next(Event event) { return awaiters_.next(event); }
+
+    // dispatches recorded events immediately; they are not journaled again
+    uint32_t replay(const Mif::JournalRecord* records, uint32_t count);
+
+#if MIF_DISPATCH_STATS
+    // observers are stats entries 0..kMaxObservers-1, in the order they
+    // were added (a removed observer's entry is reused);
+    // delegate id j is kMaxObservers + j
+    static const int kNumStatsSlots = 2 * kMaxObservers;
+
+    void setDispatchStats(Mif::DispatchStats* stats) { stats_ = stats; }
+#endif
+
 protected:
-    void notify(const Entity& entity, Event event);
+    void notify(EntityHandle entity, Event event);
 
 private:
-    static const int kMaxObservers = 10;
+    static const uint32_t kQueueCapacity = 1024;
+
+    typedef Mif::EventQueue<EntityHandle, Event, kQueueCapacity, EVENT_NUM> EventQueue;
+
+    // one entry per observer, kept sorted in dispatch order
+    struct ObserverEntry
+    {
+        Observer* observer;
+        ObserverPhase phase;
+        int priority;
+        bool canConsume;
+#if MIF_DISPATCH_STATS
+        int statsSlot;  // stays the same while the observer is added
+#endif
+    };
+
+    struct BatchTask
+    {
+        Observer* observer;
+        Event event;
+        const EventQueue::Record* records;
+        uint32_t count;
+        bool canConsume;
+        uint8_t* consumed;  // per record, nullptr if no observer consumes
+#if MIF_DISPATCH_STATS
+        Mif::DispatchStats* stats;
+        uint32_t slot;
+#endif
+    };
 
     void createEntity();
+    void dispatch(EntityHandle entity, Event event);
+    void dispatchBatch(Event event, const EventQueue::Record* records, uint32_t count);
+    static void runBatchTask(void* arg);
 
-    Observer* observers_[kMaxObservers];
+    ObserverEntry observers_[kMaxObservers];
     int numObservers_;
-    Entity* entity_;
+    int numConsumers_;
+    ObserverDelegate delegates_[kMaxObservers];
+    int numDelegates_;
+    EntityHandle entity_;
+
+    DispatchMode mode_;
+    unique_ptr<EventQueue> queue_;
+    EventBus* bus_;
+    Mif::ThreadPool* pool_;
+    Mif::EventJournal* journal_;
+    EventAwaiters awaiters_;
+#if MIF_DISPATCH_STATS
+    Mif::DispatchStats* stats_;
+#endif
 
     static uint32_t numEntity_;
 };
@@ -133,66 +462,662 @@ void Subject::createEntity()
 {
     static int numEntity = 0;
 
-    entity_ = new Entity(numEntity);
+    entity_ = entities().emplace(numEntity);
     numEntity++;
 }
 
-void Subject::addObserver(Observer* observer)
+void Subject::addObserver(Observer* observer, ObserverPhase phase, int priority)
+{
+    assert(numObservers_ < kMaxObservers && "cannot add observer\n");
+
+    // sorted here once, so that dispatch just walks the array
+    int pos = numObservers_;
+
+    for (int i = 0; i < numObservers_; i++)
+    {
+        const ObserverEntry& entry = observers_[i];
+
+        if (entry.phase > phase || (entry.phase == phase && entry.priority < priority))
+        {
+            pos = i;
+            break;
+        }
+    }
+
+#if MIF_DISPATCH_STATS
+    // lowest entry not used by another observer
+    uint32_t used = 0;
+
+    for (int i = 0; i < numObservers_; i++)
+    {
+        used |= 1u << observers_[i].statsSlot;
+    }
+
+    const int statsSlot = __builtin_ctz(~used);
+#endif
+
+    for (int i = numObservers_; i > pos; i--)
+    {
+        observers_[i] = observers_[i - 1];
+    }
+
+    ObserverEntry& entry = observers_[pos];
+    entry.observer = observer;
+    entry.phase = phase;
+    entry.priority = priority;
+    entry.canConsume = observer->canConsume();
+#if MIF_DISPATCH_STATS
+    entry.statsSlot = statsSlot;
+#endif
+    numObservers_++;
+
+    if (entry.canConsume)
+        numConsumers_++;
+}
+
+int Subject::addObserver(const ObserverDelegate& delegate)
 {
     for (int i = 0; i < kMaxObservers; i++)
     {
-        if (observers_[i] == nullptr)
+        if (!delegates_[i])
         {
-            observers_[i] = observer;
-            return;
+            delegates_[i] = delegate;
+            numDelegates_ = max(numDelegates_, i + 1);
+            return i;
         }
     }
 
     assert(false && "cannot add observer\n");
+    return -1;
+}
+
+void Subject::removeObserver(int id)
+{
+    assert(id >= 0 && id < kMaxObservers);
+    delegates_[id].reset();
 }
 
 void Subject::removeObserver(const Observer* observer)
 {
-    for (int i = 0; i < kMaxObservers; i++)
+    int kept = 0;
+
+    for (int i = 0; i < numObservers_; i++)
     {
-        if (observers_[i] == observer)
+        if (observers_[i].observer == observer)
         {
-            observers_[i] = nullptr;
+            if (observers_[i].canConsume)
+                numConsumers_--;
+
+            continue;
         }
+
+        observers_[kept++] = observers_[i];
     }
+
+    numObservers_ = kept;
 }
 
 void Subject::fall()
 {
     // do something to fall
 
-    notify(*entity_, Event::EVENT_ENTITY_FELL);
+    notify(entity_, Event::EVENT_ENTITY_FELL);
+
+}
+
+void Subject::update(const Mif::SurfaceGrid& surfaces)
+{
+    Entity& e = entity();
+    const bool wasOnSurface = e.isOnSurface();
+
+    e.setFloor(surfaces.floorAt(e.posX(), e.posY()));
+    e.update();
+
+    if (wasOnSurface && !e.isOnSurface())
+        fall();
+}
+
+void Subject::setDispatchMode(DispatchMode mode)
+{
+    if (mode == DispatchMode::QUEUED && !queue_)
+    {
+        queue_.reset(new EventQueue());
+    }
+
+    if (mode != DispatchMode::QUEUED && queue_)
+    {
+        flush();
+    }
+
+    mode_ = mode;
+}
+
+void Subject::notify(EntityHandle entity, Event event)
+{
+    MIF_LOG(TRACE, "\n");
+
+    if (journal_)
+        journal_->record(entity.bits(), event);
+
+    if (mode_ == DispatchMode::IMMEDIATE)
+    {
+        dispatch(entity, event);
+        return;
+    }
+
+    if (mode_ == DispatchMode::BUS)
+    {
+        assert(bus_ && "no event bus is set\n");
+        const EventRecord record = { entity, event };
+        bus_->publish(record);
+        return;
+    }
+
+    if (!queue_->push(entity, event))
+    {
+        // an observer filled the queue during flush(), which cannot drain
+        // it again from here, so this event goes out right away
+        if (queue_->flushing())
+        {
+            dispatch(entity, event);
+            return;
+        }
+
+        // queue is full, so drain it here rather than dropping the event
+        flush();
+        queue_->push(entity, event);
+    }
+}
+
+void Subject::flush(bool coalesce)
+{
+    if (!queue_)
+        return;
+
+    queue_->flush([this](Event event, const EventQueue::Record* records, uint32_t count) {
+        dispatchBatch(event, records, count);
+    }, coalesce);
+}
 
+uint32_t Subject::replay(const Mif::JournalRecord* records, uint32_t count)
+{
+    return Mif::replay(records, count, [this](uint64_t entity, uint32_t event) {
+        dispatch(EntityHandle::fromBits(entity), static_cast<Event>(event));
+    });
+}
+
+void Subject::dispatch(EntityHandle entity, Event event)
+{
+    const EventQueue::Record record = { entity, event };
+    dispatchBatch(event, &record, 1);
 }
 
-void Subject::notify(const Entity& entity, Event event)
+void Subject::dispatchBatch(Event event, const EventQueue::Record* records, uint32_t count)
 {
-    VSPRINTF("");
+    // observer-major order: one observer handles the whole batch
+    // before the next one is called
+    BatchTask tasks[kMaxObservers];
+    Mif::WaitGroup group;
+#if MIF_DISPATCH_STATS
+    uint32_t fanOut = 0;
+#endif
+
+    // consumed records are skipped by every observer after the consumer
+    uint8_t consumedStorage[kQueueCapacity];
+    uint8_t* const consumed = numConsumers_ > 0 ? consumedStorage : nullptr;
+
+    if (consumed)
+    {
+        assert(count <= kQueueCapacity);
+        memset(consumed, 0, count);
+    }
+
     for (int i = 0; i < numObservers_; i++)
     {
-        if (observers_[i])
-            observers_[i]->onNotify(entity, event);
+        const ObserverEntry& entry = observers_[i];
+        Observer* const observer = entry.observer;
+
+        BatchTask& task = tasks[i];
+        task.observer = observer;
+        task.event = event;
+        task.records = records;
+        task.count = count;
+        task.canConsume = entry.canConsume;
+        task.consumed = consumed;
+#if MIF_DISPATCH_STATS
+        task.stats = stats_;
+        task.slot = entry.statsSlot;
+        fanOut++;
+#endif
+
+        if (entry.canConsume)
+        {
+            // everything ordered before a consumer must have finished
+            if (pool_)
+                pool_->wait(group);
+
+            runBatchTask(&task);
+        }
+        else if (pool_ && observer->isParallelSafe())
+        {
+            const Mif::Task poolTask = { &Subject::runBatchTask, &task, &group };
+            pool_->submit(poolTask);
+        }
+        else
+        {
+            runBatchTask(&task);
+        }
+    }
+
+    for (int i = 0; i < numDelegates_; i++)
+    {
+        const ObserverDelegate& delegate = delegates_[i];
+
+        if (!delegate)
+            continue;
+
+#if MIF_DISPATCH_STATS
+        fanOut++;
+
+        if (stats_)
+        {
+            for (uint32_t j = 0; j < count; j++)
+            {
+                if (consumed && consumed[j])
+                    continue;
+
+                const uint64_t start = Mif::readTimestamp();
+                delegate(records[j].entity, event);
+                stats_->recordCall(kMaxObservers + i, Mif::readTimestamp() - start);
+            }
+
+            continue;
+        }
+#endif
+
+        for (uint32_t j = 0; j < count; j++)
+        {
+            if (consumed && consumed[j])
+                continue;
+
+            delegate(records[j].entity, event);
+        }
+    }
+
+#if MIF_DISPATCH_STATS
+    if (stats_)
+        stats_->recordFanOut(event, fanOut, count);
+#endif
+
+    // completion barrier: tasks[] lives on this stack frame
+    if (pool_)
+        pool_->wait(group);
+
+    if (awaiters_.numWaiting(event) > 0)
+    {
+        for (uint32_t j = 0; j < count; j++)
+        {
+            if (consumed && consumed[j])
+                continue;
+
+            awaiters_.resume(records[j].entity, event);
+        }
+    }
+}
+
+void Subject::runBatchTask(void* arg)
+{
+    const BatchTask& task = *static_cast<const BatchTask*>(arg);
+
+#if MIF_DISPATCH_STATS
+    const bool plain = !task.consumed && !task.stats;
+#else
+    const bool plain = !task.consumed;
+#endif
+
+    if (plain)
+    {
+        for (uint32_t j = 0; j < task.count; j++)
+        {
+            task.observer->onNotify(task.records[j].entity, task.event);
+        }
+
+        return;
+    }
+
+    for (uint32_t j = 0; j < task.count; j++)
+    {
+        if (task.consumed && task.consumed[j])
+            continue;
+
+#if MIF_DISPATCH_STATS
+        const uint64_t start = task.stats ? Mif::readTimestamp() : 0;
+#endif
+
+        if (task.canConsume)
+        {
+            if (task.observer->onNotifyConsume(task.records[j].entity, task.event))
+                task.consumed[j] = 1;
+        }
+        else
+        {
+            task.observer->onNotify(task.records[j].entity, task.event);
+        }
+
+#if MIF_DISPATCH_STATS
+        if (task.stats)
+            task.stats->recordCall(task.slot, Mif::readTimestamp() - start);
+#endif
+    }
+}
+
+/***************************************************************/
+/*
+   EventDispatcher drains an EventBus on its own threads.
+   Observers registered here may be called from any dispatcher thread.
+*/
+
+class EventDispatcher
+{
+public:
+    explicit EventDispatcher(EventBus& bus)
+        : bus_(bus)
+        , running_(false)
+    {}
+
+    ~EventDispatcher()
+    {
+        stop();
+    }
+
+    void addObserver(Observer* observer) { observers_.push_back(observer); }
+
+    void start(int numThreads);
+    void stop();
+
+private:
+    static const size_t kBatchSize = 64;
+
+    void run();
+
+    EventBus& bus_;
+    vector<Observer*> observers_;
+    vector<thread> threads_;
+    atomic<bool> running_;
+};
+
+void EventDispatcher::start(int numThreads)
+{
+    assert(!running_ && "dispatcher is already running\n");
+
+    running_ = true;
+
+    for (int i = 0; i < numThreads; i++)
+    {
+        threads_.emplace_back(&EventDispatcher::run, this);
+    }
+}
+
+void EventDispatcher::stop()
+{
+    running_ = false;
+
+    for (thread& t : threads_)
+    {
+        t.join();
+    }
+
+    threads_.clear();
+}
+
+void EventDispatcher::run()
+{
+    const auto deliver = [this](const EventRecord& record) {
+        for (Observer* observer : observers_)
+        {
+            observer->onNotify(record.entity, record.event);
+        }
+    };
+
+    for (;;)
+    {
+        // sampled before consuming, so that events published before stop()
+        // are drained before leaving
+        const bool running = running_;
+
+        if (bus_.consume(deliver, kBatchSize) > 0)
+            continue;
+
+        if (!running)
+            break;
+
+        this_thread::yield();
     }
 }
 
 
+/***************************************************************/
+/*
+   sequential logic as a coroutine instead of a state machine in an observer
+*/
+
+Mif::Script countFalls(Subject& subject, int numFalls, int& numFinished)
+{
+    for (int i = 0; i < numFalls; i++)
+    {
+        co_await subject.next(EVENT_ENTITY_FELL);
+    }
+
+    numFinished++;
+}
+
+
 /***************************************************************/
 
 int main()
 {
-    Achievement achievementA, achievementB;
+    // one player per entity slot; the first fall, and every fifth
+    Mif::AchievementEngine subjectAchievements(EVENT_NUM);
+    subjectAchievements.defineAchievement(EVENT_ENTITY_FELL, 1);
+    subjectAchievements.defineAchievement(EVENT_ENTITY_FELL, 5);
+    subjectAchievements.compile();
+    subjectAchievements.addPlayers(16);
+
+    Achievement achievementA(&subjectAchievements), achievementB;
 
     Subject subjectA;
     subjectA.addObserver(&achievementA);
     subjectA.addObserver(&achievementB);
+
+    int numFalls = 0;
+    const int fallCounter = subjectA.addObserver([&numFalls](EntityHandle, Event event) {
+        if (event == EVENT_ENTITY_FELL)
+            numFalls++;
+    });
+
+#if MIF_DISPATCH_STATS
+    Mif::DispatchStats stats(Subject::kNumStatsSlots, EVENT_NUM);
+    stats.setObserverName(0, "achievementA");
+    stats.setObserverName(1, "achievementB");
+    stats.setObserverName(Subject::kMaxObservers + fallCounter, "fallCounter");
+    subjectA.setDispatchStats(&stats);
+#else
+    (void)fallCounter;
+#endif
+
+    subjectA.fall();
+
+    subjectA.setDispatchMode(DispatchMode::QUEUED);
     subjectA.fall();
+    subjectA.fall();
+    subjectA.flush(true);
+
+    EventBus bus(256, Mif::Backpressure::BLOCK);
+    EventDispatcher dispatcher(bus);
+    dispatcher.addObserver(&achievementA);
+    dispatcher.start(1);
+
+    subjectA.setEventBus(&bus);
+    subjectA.setDispatchMode(DispatchMode::BUS);
+    subjectA.fall();
+
+    dispatcher.stop();
+
+    Mif::ThreadPool pool(2);
+    subjectA.setThreadPool(&pool);
+    subjectA.setDispatchMode(DispatchMode::IMMEDIATE);
+    subjectA.fall();
+
+    VSPRINTF("entity fell %d times\n", numFalls);
+
+    Shield shield;
+    subjectA.addObserver(&shield, ObserverPhase::PRE);
+    shield.setUp(true);
+    subjectA.fall();  // consumed before the achievements see it
+    shield.setUp(false);
+    subjectA.removeObserver(&shield);
+
+    VSPRINTF("entity fell %d times with the shield up\n", numFalls);
+
+    Mif::EventPublisher publisher;
+    Mif::EventSubscriber subscriber;
+
+    if (publisher.open("/tmp/observer.pub") && subscriber.open("/tmp/observer.sub", "/tmp/observer.pub"))
+    {
+        publisher.pollSubscriptions();
+
+        RemoteObserver remote(publisher);
+        subjectA.addObserver(&remote, ObserverPhase::POST);
+        subjectA.fall();
+        subjectA.fall();
+        remote.flush();
+        subjectA.removeObserver(&remote);
+
+        uint32_t numRemote = 0;
+        subscriber.poll(1000, [&numRemote](const Mif::WireRecord*, uint32_t count) {
+            numRemote += count;
+        });
+
+        VSPRINTF("subscriber received %u events in one batch\n", numRemote);
+    }
+
+    StaticAchievement staticA, staticB;
+    auto staticSubject = Mif::makeStaticSubject<EntityHandle, Event>(staticA, staticB);
+    const EntityHandle hero = entities().emplace(100);
+
+    for (int i = 0; i < 3; i++)
+    {
+        staticSubject.notify<EVENT_ENTITY_FELL>(hero);
+    }
+
+    VSPRINTF("static achievement saw %d falls\n", staticA.numFalls());
+
+    entities().erase(hero);
+
+    const uint32_t kNumEntities = 100000;
+    const int kGravity = -10;
+
+    // a bridge over the ground; entities walk right and drop off its end
+    Mif::SurfaceGrid surfaces(0.0f, 1000.0f, 10.0f);
+    surfaces.add(Mif::Surface{ 0.0f, 500.0f, 5.0f });
+    surfaces.build();
+
+    Mif::EventJournal journal(256);
+    subjectA.setJournal(&journal);
+
+    const int kNumScripts = 1000;
+    Mif::PoolAllocator scriptFrames(256);
+    vector<Mif::Script> scripts;
+    int numFinished = 0;
+
+    {
+        Mif::ScriptFrames scope(scriptFrames);
+
+        for (int i = 0; i < kNumScripts; i++)
+        {
+            scripts.push_back(countFalls(subjectA, 1 + i % 2, numFinished));
+        }
+    }
+
+    numFalls = 0;
+    subjectA.entity().moveTo(499.0f, 5.0f);
+    subjectA.entity().setVelocityX(60.0f);
+
+    for (int tick = 0; tick < 60; tick++)
+    {
+        subjectA.entity().accelerate(kGravity);
+        subjectA.update(surfaces);
+    }
+
+    VSPRINTF("entity fell %d times\n", numFalls);
+    VSPRINTF("%d of %d scripts finished\n", numFinished, kNumScripts);
+
+    scripts.clear();
+    subjectA.setJournal(nullptr);
+    Mif::MappedJournal recorded;
+
+    if (journal.flushToFile("/tmp/observer.journal") && recorded.open("/tmp/observer.journal"))
+    {
+        numFalls = 0;
+        subjectA.replay(recorded.records(), recorded.size());
+        VSPRINTF("replayed %u journaled events, entity fell %d times\n", recorded.size(), numFalls);
+    }
+
+    Mif::EntityStore store(kNumEntities);
+
+    Mif::EntityId entity499;
+
+    for (uint32_t i = 0; i < kNumEntities; i++)
+    {
+        const Mif::EntityId id = store.create(static_cast<float>(i % 1000), 5.0f);
+        store.velX()[store.indexOf(id)] = 60.0f;
+
+        if (i == 499)
+            entity499 = id;
+    }
+
+    Mif::AchievementEngine achievements(EVENT_NUM);
+    const Mif::AchievementId firstFall = achievements.defineAchievement(EVENT_ENTITY_FELL, 1);
+    achievements.compile();
+    achievements.addPlayers(kNumEntities);
+
+    Mif::ChangeTracker tracker;
+    std::vector<Mif::PlayerEvent> tickEvents;
+    uint32_t numFell = 0;
+    uint32_t numUnlocks = 0;
+    uint32_t numChanges = 0;
+
+    for (int tick = 0; tick < 60; tick++)
+    {
+        store.accelerateAll(kGravity, kTimeStep);
+        numChanges += Mif::stepEntities(store, surfaces, kTimeStep, tracker);
+
+        // only entities which changed state show up here
+        for (const Mif::StateChange& change : tracker.changes())
+        {
+            if (change.transition == Mif::Transition::LEFT_SURFACE)
+            {
+                // the slot stays put for the entity's lifetime; the dense index does not
+                const Mif::PlayerEvent event = { change.entity.index(), EVENT_ENTITY_FELL, 1 };
+                tickEvents.push_back(event);
+            }
+        }
+
+        numFell += static_cast<uint32_t>(tickEvents.size());
+        numUnlocks += achievements.evaluate(tickEvents.data(), static_cast<uint32_t>(tickEvents.size()));
+        tickEvents.clear();
+        tracker.clearChanges();
+    }
+
+    VSPRINTF("%u of %u entities fell off the bridge (%u state changes in %u entity ticks)\n",
+            numFell, store.size(), numChanges, store.size() * 60);
+    VSPRINTF("%u achievements unlocked; entity 499 unlocked first fall: %d, %zu bytes of achievement state per player\n",
+            numUnlocks, achievements.isUnlocked(entity499.index(), firstFall), achievements.bytesPerPlayer());
+
+#if MIF_DISPATCH_STATS
+    Mif::logFlush();
+    stats.dump(stdout);
+#endif
 
     return 0;
 }
-
-// todo: check why subject::fall() never called?
@@ -0,0 +1,351 @@
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "event_bus.h"  // kCacheLineSize
+#include "memory_allocator.h"  // roundUpPow2
+#include "shm_ring.h"
+
+namespace Mif {
+
+    namespace {
+        const uint32_t kRingMagic = 0x474e5252; // "RRNG"
+        const uint32_t kRingVersion = 1;
+        const uint32_t kSpinCount = 2000;   // tryPop() attempts before parking on the eventfd
+
+        // spinning only pays off if the producer runs on another CPU meanwhile
+        uint32_t spinCount()
+        {
+            static const uint32_t count = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? kSpinCount : 1;
+            return count;
+        }
+    } // namespace anonymouse
+
+
+    // lives at offset 0 of the memfd; slots follow it
+    struct ShmRing::Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t capacity;
+        uint32_t slotSize;
+
+        alignas(kCacheLineSize) std::atomic<uint64_t> head;           // written by the producer
+        alignas(kCacheLineSize) std::atomic<uint64_t> tail;           // written by the consumer
+        alignas(kCacheLineSize) std::atomic<uint32_t> consumerWaiting;
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring indices must be lock free to be shared");
+
+
+    ShmRing::ShmRing()
+    : m_memfd(-1)
+    , m_eventfd(-1)
+    , m_header(nullptr)
+    , m_length(0)
+    , m_mask(0)
+    , m_slotSize(0)
+    , m_cachedTail(0)
+    , m_cachedHead(0)
+    {
+        ;
+    }
+
+
+    ShmRing::~ShmRing()
+    {
+        close();
+    }
+
+
+    bool ShmRing::create(uint32_t capacity, uint32_t slotSize)
+    {
+        assert(slotSize > sizeof(uint32_t) && slotSize % 8 == 0 && "slot must hold a length and be 8-byte aligned");
+
+        close();
+
+        const uint32_t slots = roundUpPow2(capacity);
+        const size_t length = sizeof(Header) + static_cast<size_t>(slots) * slotSize;
+
+        const int memfd = memfd_create("mif-shm-ring", MFD_CLOEXEC);
+
+        if (memfd < 0)
+            return false;
+
+        if (ftruncate(memfd, length) < 0)
+        {
+            closeKeepErrno(memfd);
+            return false;
+        }
+
+        void* const base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+
+        if (base == MAP_FAILED)
+        {
+            closeKeepErrno(memfd);
+            return false;
+        }
+
+        Header* const header = new (base) Header();
+        header->magic = kRingMagic;
+        header->version = kRingVersion;
+        header->capacity = slots;
+        header->slotSize = slotSize;
+        header->head.store(0, std::memory_order_relaxed);
+        header->tail.store(0, std::memory_order_relaxed);
+        header->consumerWaiting.store(0, std::memory_order_relaxed);
+        munmap(base, length);
+
+        const int efd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+        if (efd < 0)
+        {
+            closeKeepErrno(memfd);
+            return false;
+        }
+
+        return attach(memfd, efd);
+    }
+
+
+    bool ShmRing::attach(int memfd, int eventfd)
+    {
+        close();
+
+        struct stat st;
+        Header header;
+
+        if (fstat(memfd, &st) < 0 || pread(memfd, &header, sizeof(header.magic) * 4, 0) != sizeof(header.magic) * 4)
+        {
+            closeKeepErrno(memfd);
+            closeKeepErrno(eventfd);
+            return false;
+        }
+
+        const size_t length = sizeof(Header) + static_cast<size_t>(header.capacity) * header.slotSize;
+
+        if (header.magic != kRingMagic || header.version != kRingVersion
+                || header.capacity == 0 || (header.capacity & (header.capacity - 1)) != 0
+                || header.slotSize <= sizeof(uint32_t) || header.slotSize % 8 != 0
+                || static_cast<size_t>(st.st_size) < length)
+        {
+            ::close(memfd);
+            ::close(eventfd);
+            errno = EINVAL;
+            return false;
+        }
+
+        void* const base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+
+        if (base == MAP_FAILED)
+        {
+            closeKeepErrno(memfd);
+            closeKeepErrno(eventfd);
+            return false;
+        }
+
+        m_memfd = memfd;
+        m_eventfd = eventfd;
+        m_header = static_cast<Header*>(base);
+        m_length = length;
+        m_mask = header.capacity - 1;
+        m_slotSize = header.slotSize;
+        m_cachedTail = m_header->tail.load(std::memory_order_acquire);
+        m_cachedHead = m_header->head.load(std::memory_order_acquire);
+
+        return true;
+    }
+
+
+    bool ShmRing::sendFds(FdChannel& channel) const
+    {
+        assert(isOpen());
+
+        const int fds[2] = { m_memfd, m_eventfd };
+        const char tag = 'R';
+
+        return channel.sendFds(fds, 2, &tag, sizeof(tag));
+    }
+
+
+    bool ShmRing::receiveFds(FdChannel& channel)
+    {
+        int fds[2];
+        char tag = 0;
+        const int count = channel.recvFds(fds, 2, &tag, sizeof(tag));
+
+        if (count < 0)
+            return false;
+
+        if (count != 2 || tag != 'R')
+        {
+            for (int i = 0; i < count; i++)
+            {
+                ::close(fds[i]);
+            }
+
+            errno = EBADMSG;
+            return false;
+        }
+
+        return attach(fds[0], fds[1]);
+    }
+
+
+    void ShmRing::close()
+    {
+        if (m_header)
+            munmap(m_header, m_length);
+
+        if (m_memfd >= 0)
+            ::close(m_memfd);
+
+        if (m_eventfd >= 0)
+            ::close(m_eventfd);
+
+        m_memfd = -1;
+        m_eventfd = -1;
+        m_header = nullptr;
+        m_length = 0;
+        m_mask = 0;
+        m_slotSize = 0;
+    }
+
+
+    uint8_t* ShmRing::slot(uint64_t index) const
+    {
+        return reinterpret_cast<uint8_t*>(m_header + 1) + (index & m_mask) * m_slotSize;
+    }
+
+
+    bool ShmRing::tryPush(const void* data, uint32_t length)
+    {
+        assert(length <= maxMessageSize() && "message does not fit in a slot");
+
+        const uint64_t head = m_header->head.load(std::memory_order_relaxed);
+
+        if (head - m_cachedTail > m_mask)
+        {
+            m_cachedTail = m_header->tail.load(std::memory_order_acquire);
+
+            if (head - m_cachedTail > m_mask)
+                return false;
+        }
+
+        uint8_t* const s = slot(head);
+        memcpy(s, &length, sizeof(length));
+        memcpy(s + sizeof(length), data, length);
+
+        m_header->head.store(head + 1, std::memory_order_release);
+
+        // pairs with the fence in pop(): either the consumer sees the new
+        // head, or this sees that it is going to sleep
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (m_header->consumerWaiting.load(std::memory_order_relaxed))
+            wakeConsumer();
+
+        return true;
+    }
+
+
+    int ShmRing::tryPop(void* out, uint32_t maxLength)
+    {
+        const uint64_t tail = m_header->tail.load(std::memory_order_relaxed);
+
+        if (tail == m_cachedHead)
+        {
+            m_cachedHead = m_header->head.load(std::memory_order_acquire);
+
+            if (tail == m_cachedHead)
+                return -1;
+        }
+
+        const uint8_t* const s = slot(tail);
+        uint32_t length;
+        memcpy(&length, s, sizeof(length));
+
+        // the peer can write anything here; never read past the slot
+        if (length > maxMessageSize())
+            length = maxMessageSize();
+
+        if (length > maxLength)
+            length = maxLength;
+
+        memcpy(out, s + sizeof(length), length);
+
+        m_header->tail.store(tail + 1, std::memory_order_release);
+
+        return static_cast<int>(length);
+    }
+
+
+    int ShmRing::pop(void* out, uint32_t maxLength, int timeoutMs)
+    {
+        const uint32_t spins = spinCount();
+
+        for (;;)
+        {
+            for (uint32_t spin = 0; spin < spins; spin++)
+            {
+                const int length = tryPop(out, maxLength);
+
+                if (length >= 0)
+                    return length;
+            }
+
+            m_header->consumerWaiting.store(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            // a push may have landed between tryPop() and the flag
+            if (m_header->head.load(std::memory_order_acquire) != m_header->tail.load(std::memory_order_relaxed))
+            {
+                m_header->consumerWaiting.store(0, std::memory_order_relaxed);
+                continue;
+            }
+
+            pollfd pfd = { m_eventfd, POLLIN, 0 };
+            const int ready = ::poll(&pfd, 1, timeoutMs);
+
+            m_header->consumerWaiting.store(0, std::memory_order_relaxed);
+
+            uint64_t value;
+
+            if (ready > 0 && read(m_eventfd, &value, sizeof(value)) < 0 && errno != EAGAIN)
+                return -1;
+
+            if (ready == 0)
+                return tryPop(out, maxLength);  // timed out
+
+            if (ready < 0 && errno != EINTR)
+                return -1;
+        }
+    }
+
+
+    void ShmRing::wakeConsumer()
+    {
+        m_header->consumerWaiting.store(0, std::memory_order_relaxed);
+
+        const uint64_t one = 1;
+        ssize_t n;
+
+        do {
+            n = write(m_eventfd, &one, sizeof(one));
+        } while (n < 0 && errno == EINTR);
+    }
+
+
+    uint32_t ShmRing::size() const
+    {
+        const uint64_t head = m_header->head.load(std::memory_order_acquire);
+        const uint64_t tail = m_header->tail.load(std::memory_order_acquire);
+
+        return static_cast<uint32_t>(head - tail);
+    }
+
+} // namespace Mif
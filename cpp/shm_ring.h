@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include "fd_channel.h"
+
+// Single-producer/single-consumer ring in shared memory.
+//
+// One process create()s the ring: a memfd holding the indices and slots, and
+// an eventfd for wakeups. Both fds go to the peer in one FdChannel message;
+// the peer maps the same memory. From then on messages move with plain
+// loads and stores. The eventfd is only written when the consumer is
+// actually asleep.
+//
+// The peer is not trusted with the layout: attach() validates the header,
+// and tryPop() never reads past a slot whatever length the peer stored.
+
+namespace Mif {
+
+    class ShmRing {
+    public:
+        static const uint32_t kDefaultSlotSize = 64;  // one cache line, length included
+
+        ShmRing();
+        ~ShmRing();
+
+        ShmRing(const ShmRing&) = delete;
+        ShmRing& operator=(const ShmRing&) = delete;
+
+        // capacity is rounded up to a power of two; false with errno on failure
+        bool create(uint32_t capacity, uint32_t slotSize = kDefaultSlotSize);
+
+        // maps a ring created elsewhere; takes ownership of both fds
+        bool attach(int memfd, int eventfd);
+
+        // hands both fds to the peer in one message, and the other way round
+        bool sendFds(FdChannel& channel) const;
+        bool receiveFds(FdChannel& channel);
+
+        void close();
+
+        // producer side; false if the ring is full
+        bool tryPush(const void* data, uint32_t length);
+
+        // consumer side; returns the number of bytes copied to out, or -1 if
+        // the ring is empty. A message longer than maxLength is truncated.
+        int tryPop(void* out, uint32_t maxLength);
+
+        // like tryPop(), but spins briefly and then sleeps on the eventfd for
+        // up to timeoutMs (-1: forever) while the ring is empty; returns -1
+        // on timeout
+        int pop(void* out, uint32_t maxLength, int timeoutMs);
+
+        uint32_t capacity() const { return m_mask + 1; }
+        uint32_t maxMessageSize() const { return m_slotSize - sizeof(uint32_t); }
+        uint32_t size() const;
+        bool isOpen() const { return m_header != nullptr; }
+
+    private:
+        struct Header;
+
+        uint8_t* slot(uint64_t index) const;
+        void wakeConsumer();
+
+        int m_memfd;
+        int m_eventfd;
+        Header* m_header;
+        size_t m_length;
+        uint32_t m_mask;
+        uint32_t m_slotSize;
+
+        // local copies of the peer's index, refreshed only when they look exhausted
+        uint64_t m_cachedTail;
+        uint64_t m_cachedHead;
+    };
+
+} // namespace Mif
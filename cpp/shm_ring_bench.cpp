@@ -0,0 +1,143 @@
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+#include <thread>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include "shm_ring.h"
+
+using namespace std;
+
+// Round trip latency between two processes: a ShmRing pair handed over with
+// SCM_RIGHTS against write()/read() on a socketpair. The ring is measured
+// busy polling (tryPop) and with pop(), which parks on the eventfd. Busy
+// polling needs a core for each side; it is skipped on a single CPU.
+
+#define VPRINTF(...) \
+    do { \
+        printf(__VA_ARGS__); \
+    } while (false)
+
+namespace {
+
+    const uint32_t kRoundTrips = 200 * 1000;
+
+    enum class Wait { SPIN, SLEEP };
+
+    uint64_t receive(Mif::ShmRing& ring, Wait wait)
+    {
+        uint64_t value = 0;
+
+        if (wait == Wait::SLEEP)
+        {
+            ring.pop(&value, sizeof(value), -1);
+            return value;
+        }
+
+        while (ring.tryPop(&value, sizeof(value)) < 0)
+        {
+            ;
+        }
+
+        return value;
+    }
+
+    double benchRing(Wait wait)
+    {
+        Mif::FdChannel sender, receiver;
+        Mif::FdChannel::pair(sender, receiver);
+
+        Mif::ShmRing ping, pong;
+        ping.create(64);
+        pong.create(64);
+        ping.sendFds(sender);
+        pong.sendFds(sender);
+
+        const pid_t pid = fork();
+
+        if (pid == 0)
+        {
+            Mif::ShmRing in, out;
+            in.receiveFds(receiver);
+            out.receiveFds(receiver);
+
+            for (uint32_t i = 0; i < kRoundTrips; i++)
+            {
+                const uint64_t value = receive(in, wait);
+                out.tryPush(&value, sizeof(value));
+            }
+
+            _exit(0);
+        }
+
+        const auto start = chrono::steady_clock::now();
+
+        for (uint64_t i = 0; i < kRoundTrips; i++)
+        {
+            ping.tryPush(&i, sizeof(i));
+            receive(pong, wait);
+        }
+
+        const auto end = chrono::steady_clock::now();
+
+        waitpid(pid, nullptr, 0);
+
+        return chrono::duration<double, nano>(end - start).count() / kRoundTrips;
+    }
+
+    double benchSocket()
+    {
+        int sockets[2];
+        socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sockets);
+
+        const pid_t pid = fork();
+
+        if (pid == 0)
+        {
+            uint64_t value;
+
+            for (uint32_t i = 0; i < kRoundTrips; i++)
+            {
+                if (read(sockets[1], &value, sizeof(value)) != sizeof(value)
+                        || write(sockets[1], &value, sizeof(value)) != sizeof(value))
+                    _exit(1);
+            }
+
+            _exit(0);
+        }
+
+        const auto start = chrono::steady_clock::now();
+
+        for (uint64_t i = 0; i < kRoundTrips; i++)
+        {
+            uint64_t value = i;
+
+            if (write(sockets[0], &value, sizeof(value)) != sizeof(value)
+                    || read(sockets[0], &value, sizeof(value)) != sizeof(value))
+                break;
+        }
+
+        const auto end = chrono::steady_clock::now();
+
+        waitpid(pid, nullptr, 0);
+        close(sockets[0]);
+        close(sockets[1]);
+
+        return chrono::duration<double, nano>(end - start).count() / kRoundTrips;
+    }
+
+} // namespace anonymouse
+
+
+int main()
+{
+    VPRINTF("%u round trips, 8 byte messages, ns per round trip\n", kRoundTrips);
+    if (thread::hardware_concurrency() > 1)
+        VPRINTF("%-24s %10.1f\n", "ShmRing busy poll", benchRing(Wait::SPIN));
+
+    VPRINTF("%-24s %10.1f\n", "ShmRing pop", benchRing(Wait::SLEEP));
+    VPRINTF("%-24s %10.1f\n", "socketpair", benchSocket());
+
+    return 0;
+}
@@ -0,0 +1,180 @@
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "shm_ring.h"
+#include "gtest/gtest.h"
+
+namespace { // for constants
+    const uint32_t kCapacity = 8;
+    const uint32_t kNumMessages = 100000;
+} // namespace anonymouse
+
+namespace { // for test fixture
+    class ShmRingTest : public ::testing::Test
+    {
+    public:
+        void SetUp();
+        void TearDown();
+
+        Mif::FdChannel sender_;
+        Mif::FdChannel receiver_;
+        Mif::ShmRing producer_;
+    };
+
+    void ShmRingTest::SetUp()
+    {
+        ASSERT_TRUE(Mif::FdChannel::pair(sender_, receiver_));
+        ASSERT_TRUE(producer_.create(kCapacity));
+    }
+
+    void ShmRingTest::TearDown()
+    {
+        producer_.close();
+    }
+} // namespace anonymouse
+
+
+namespace { // for functions
+
+    TEST_F(ShmRingTest, fullAndWrapAround)
+    {
+        // a second mapping of the same memory, as the peer would see it
+        Mif::ShmRing consumer;
+        ASSERT_TRUE(producer_.sendFds(sender_));
+        ASSERT_TRUE(consumer.receiveFds(receiver_));
+
+        EXPECT_EQ(consumer.capacity(), kCapacity);
+        EXPECT_EQ(consumer.maxMessageSize(), Mif::ShmRing::kDefaultSlotSize - 4);
+
+        char text[64];
+        EXPECT_EQ(consumer.tryPop(text, sizeof(text)), -1);
+
+        for (uint32_t round = 0; round < 3; round++)
+        {
+            for (uint32_t i = 0; i < kCapacity; i++)
+            {
+                const int length = snprintf(text, sizeof(text), "message %u", round * kCapacity + i);
+                EXPECT_TRUE(producer_.tryPush(text, length));
+            }
+
+            EXPECT_FALSE(producer_.tryPush("x", 1));
+            EXPECT_EQ(consumer.size(), kCapacity);
+
+            for (uint32_t i = 0; i < kCapacity; i++)
+            {
+                char expected[64];
+                const int length = snprintf(expected, sizeof(expected), "message %u", round * kCapacity + i);
+                ASSERT_EQ(consumer.tryPop(text, sizeof(text)), length);
+                EXPECT_EQ(memcmp(text, expected, length), 0);
+            }
+
+            EXPECT_EQ(consumer.tryPop(text, sizeof(text)), -1);
+        }
+
+        // nothing arrives: pop() gives up after the timeout
+        EXPECT_EQ(consumer.pop(text, sizeof(text), 10), -1);
+    }
+
+
+    TEST_F(ShmRingTest, rejectsForeignFds)
+    {
+        int fds[2];
+        ASSERT_EQ(pipe(fds), 0);
+
+        Mif::ShmRing ring;
+        EXPECT_FALSE(ring.attach(fds[0], fds[1]));
+        EXPECT_FALSE(ring.isOpen());
+    }
+
+
+    TEST_F(ShmRingTest, distrustsPeerMemory)
+    {
+        ASSERT_TRUE(producer_.tryPush("abc", 3));
+        ASSERT_TRUE(producer_.sendFds(sender_));
+
+        // the raw memfd, as a misbehaving peer would see it
+        int fds[2];
+        char tag;
+        ASSERT_EQ(receiver_.recvFds(fds, 2, &tag, 1), 2);
+
+        std::vector<char> image(4096);
+        ASSERT_GT(pread(fds[0], image.data(), image.size(), 0), 0);
+        const char* const payload = static_cast<const char*>(memmem(image.data(), image.size(), "abc", 3));
+        ASSERT_NE(payload, nullptr);
+
+        Mif::ShmRing consumer;
+        ASSERT_TRUE(consumer.attach(dup(fds[0]), dup(fds[1])));
+
+        // a length far beyond the slot: the copy stops at the slot end
+        const uint32_t huge = 1u << 30;
+        ASSERT_EQ(pwrite(fds[0], &huge, sizeof(huge), payload - 4 - image.data()), sizeof(huge));
+
+        char out[256];
+        EXPECT_EQ(consumer.tryPop(out, sizeof(out)), static_cast<int>(consumer.maxMessageSize()));
+        EXPECT_EQ(memcmp(out, "abc", 3), 0);
+
+        // a short output buffer gets what fits, and says so
+        ASSERT_TRUE(producer_.tryPush("defgh", 5));
+        EXPECT_EQ(consumer.tryPop(out, 2), 2);
+        EXPECT_EQ(memcmp(out, "de", 2), 0);
+
+        // a slot too small to hold a length is rejected at attach()
+        const uint32_t tiny = 2;
+        ASSERT_EQ(pwrite(fds[0], &tiny, sizeof(tiny), 3 * sizeof(uint32_t)), sizeof(tiny));
+
+        Mif::ShmRing broken;
+        EXPECT_FALSE(broken.attach(fds[0], fds[1]));
+        EXPECT_EQ(errno, EINVAL);
+    }
+
+
+    TEST_F(ShmRingTest, crossProcess)
+    {
+        const pid_t pid = fork();
+        ASSERT_GE(pid, 0);
+
+        if (pid == 0)
+        {
+            // child: the consumer; blocks on the eventfd whenever it runs dry
+            producer_.close();
+
+            Mif::ShmRing consumer;
+
+            if (!consumer.receiveFds(receiver_))
+                _exit(2);
+
+            for (uint32_t i = 0; i < kNumMessages; i++)
+            {
+                uint32_t value;
+
+                if (consumer.pop(&value, sizeof(value), 5000) != sizeof(value) || value != i)
+                    _exit(1);
+            }
+
+            _exit(0);
+        }
+
+        ASSERT_TRUE(producer_.sendFds(sender_));
+
+        for (uint32_t i = 0; i < kNumMessages; i++)
+        {
+            while (!producer_.tryPush(&i, sizeof(i)))
+            {
+                ;
+            }
+
+            // let the consumer go to sleep now and then
+            if (i % 10000 == 0)
+                usleep(1000);
+        }
+
+        int status = -1;
+        ASSERT_EQ(waitpid(pid, &status, 0), pid);
+        ASSERT_TRUE(WIFEXITED(status));
+        EXPECT_EQ(WEXITSTATUS(status), 0);
+    }
+
+} // namespace anonymouse
@@ -0,0 +1,84 @@
+#include "slot_map.h"
+
+namespace Mif {
+
+    namespace {
+        const uint32_t kNoSlot = ~0u;
+    } // namespace anonymouse
+
+
+    HandleTable::HandleTable()
+    : m_freeHead(kNoSlot)
+    {
+        ;
+    }
+
+
+    void HandleTable::reserve(uint32_t n)
+    {
+        m_slots.reserve(n);
+        m_denseToSlot.reserve(n);
+    }
+
+
+    Handle HandleTable::create()
+    {
+        uint32_t slot;
+
+        if (m_freeHead == kNoSlot)
+        {
+            slot = static_cast<uint32_t>(m_slots.size());
+            m_slots.push_back(Slot{ 0, 1 });
+        }
+        else
+        {
+            slot = m_freeHead;
+            m_freeHead = m_slots[slot].dense;
+        }
+
+        m_slots[slot].dense = size();
+        m_denseToSlot.push_back(slot);
+
+        return Handle(slot, m_slots[slot].generation);
+    }
+
+
+    uint32_t HandleTable::destroy(Handle handle)
+    {
+        assert(valid(handle) && "stale or invalid handle");
+
+        Slot& slot = m_slots[handle.index()];
+        const uint32_t index = slot.dense;
+        const uint32_t lastSlot = m_denseToSlot.back();
+
+        // the last object moves into the hole
+        m_denseToSlot[index] = lastSlot;
+        m_slots[lastSlot].dense = index;
+        m_denseToSlot.pop_back();
+
+        // skip generation 0 on wrap around, it marks null handles
+        if (++slot.generation == 0)
+            slot.generation = 1;
+
+        slot.dense = m_freeHead;
+        m_freeHead = handle.index();
+
+        return index;
+    }
+
+
+    bool HandleTable::valid(Handle handle) const
+    {
+        if (handle.isNull() || handle.index() >= m_slots.size())
+            return false;
+
+        const Slot& slot = m_slots[handle.index()];
+
+        // a freed slot has moved on to the next generation, and its dense
+        // field is a free list link which does not point back to it
+        return slot.generation == handle.generation()
+            && slot.dense < size()
+            && m_denseToSlot[slot.dense] == handle.index();
+    }
+
+} // namespace Mif
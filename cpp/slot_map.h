@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <new>
+#include <utility>
+#include <vector>
+
+// reference: https://seanmiddleditch.com/data-structures-for-game-developers-the-slot-map/
+
+namespace Mif {
+
+    // 64-bit generational handle: slot index plus the generation the slot
+    // had when the handle was issued. A handle to a destroyed object stays
+    // detectably stale even after its slot is reused.
+    class Handle {
+    public:
+        Handle()
+        : m_index(0)
+        , m_generation(0)
+        {
+            ;
+        }
+
+        Handle(uint32_t index, uint32_t generation)
+        : m_index(index)
+        , m_generation(generation)
+        {
+            ;
+        }
+
+        uint32_t index() const { return m_index; }
+        uint32_t generation() const { return m_generation; }
+
+        // generation 0 is never issued, so a default handle is invalid
+        bool isNull() const { return m_generation == 0; }
+
+        uint64_t bits() const { return (static_cast<uint64_t>(m_generation) << 32) | m_index; }
+        static Handle fromBits(uint64_t bits) { return Handle(static_cast<uint32_t>(bits), static_cast<uint32_t>(bits >> 32)); }
+
+        bool operator==(const Handle& other) const { return bits() == other.bits(); }
+        bool operator!=(const Handle& other) const { return bits() != other.bits(); }
+        bool operator<(const Handle& other) const { return bits() < other.bits(); }
+
+    private:
+        uint32_t m_index;
+        uint32_t m_generation;
+    };
+
+
+    // Handle bookkeeping of a slot map, without the payload.
+    // Objects live packed in [0, size()) of one or more dense arrays owned by
+    // the caller; the table maps handles to dense indices in O(1).
+    class HandleTable {
+    public:
+        HandleTable();
+
+        void reserve(uint32_t n);
+
+        // the new object goes to dense index size() - 1
+        Handle create();
+
+        // frees the handle and returns its dense index. The caller keeps its
+        // arrays packed by moving the last element (size() before the call
+        // minus one) into that index, which is what the table now expects.
+        uint32_t destroy(Handle handle);
+
+        bool valid(Handle handle) const;
+
+        uint32_t indexOf(Handle handle) const
+        {
+            assert(valid(handle) && "stale or invalid handle");
+            return m_slots[handle.index()].dense;
+        }
+
+        Handle handleAt(uint32_t denseIndex) const
+        {
+            const uint32_t slot = m_denseToSlot[denseIndex];
+            return Handle(slot, m_slots[slot].generation);
+        }
+
+        uint32_t size() const { return static_cast<uint32_t>(m_denseToSlot.size()); }
+
+    private:
+        struct Slot {
+            uint32_t dense;       // dense index while alive, next free slot otherwise
+            uint32_t generation;
+        };
+
+        std::vector<Slot> m_slots;
+        std::vector<uint32_t> m_denseToSlot;
+        uint32_t m_freeHead;
+    };
+
+
+    // Generational slot map: O(1) insert, erase and lookup by Handle, with
+    // the objects themselves packed for dense iteration.
+    template <typename T>
+    class SlotMap {
+    public:
+        void reserve(uint32_t n)
+        {
+            m_table.reserve(n);
+            m_data.reserve(n);
+        }
+
+        template <typename... Args>
+        Handle emplace(Args&&... args)
+        {
+            m_data.emplace_back(std::forward<Args>(args)...);
+            return m_table.create();
+        }
+
+        void erase(Handle handle);
+
+        bool contains(Handle handle) const { return m_table.valid(handle); }
+
+        // null for stale handles; pointers are invalidated by emplace/erase
+        T* get(Handle handle) { return contains(handle) ? &m_data[m_table.indexOf(handle)] : nullptr; }
+        const T* get(Handle handle) const { return contains(handle) ? &m_data[m_table.indexOf(handle)] : nullptr; }
+
+        T& operator[](Handle handle) { return m_data[m_table.indexOf(handle)]; }
+        const T& operator[](Handle handle) const { return m_data[m_table.indexOf(handle)]; }
+
+        Handle handleAt(uint32_t denseIndex) const { return m_table.handleAt(denseIndex); }
+
+        uint32_t size() const { return m_table.size(); }
+        bool empty() const { return size() == 0; }
+
+        T* begin() { return m_data.data(); }
+        T* end() { return m_data.data() + m_data.size(); }
+        const T* begin() const { return m_data.data(); }
+        const T* end() const { return m_data.data() + m_data.size(); }
+
+    private:
+        HandleTable m_table;
+        std::vector<T> m_data;
+    };
+
+
+    template <typename T>
+    void SlotMap<T>::erase(Handle handle)
+    {
+        const uint32_t last = size() - 1;
+        const uint32_t index = m_table.destroy(handle);
+
+        // destroy the erased object itself, then refill its place with the last one
+        if (index != last)
+        {
+            m_data[index].~T();
+            new (&m_data[index]) T(std::move(m_data[last]));
+        }
+
+        m_data.pop_back();
+    }
+
+} // namespace Mif
@@ -0,0 +1,153 @@
+#include <cstdio>
+#include <string>
+#include <set>
+#include "slot_map.h"
+#include "gtest/gtest.h"
+
+namespace { // for constants
+    const uint32_t kNumObjects = 1000;
+
+    // counts live instances to check erase destroys exactly once
+    struct Tracked
+    {
+        static int alive;
+
+        explicit Tracked(int value) : value_(value) { alive++; }
+        Tracked(Tracked&& other) : value_(other.value_) { alive++; }
+        ~Tracked() { alive--; }
+
+        int value_;
+    };
+
+    int Tracked::alive = 0;
+} // namespace anonymouse
+
+
+namespace { // for functions
+
+    TEST(HandleTest, bits)
+    {
+        const Mif::Handle null;
+        EXPECT_TRUE(null.isNull());
+
+        const Mif::Handle h(7, 3);
+        EXPECT_FALSE(h.isNull());
+        EXPECT_EQ(Mif::Handle::fromBits(h.bits()), h);
+        EXPECT_EQ(h.bits(), (3ull << 32) | 7);
+        EXPECT_TRUE(Mif::Handle(7, 2) < h);
+    }
+
+
+    TEST(SlotMapTest, insertLookupErase)
+    {
+        Mif::SlotMap<std::string> map;
+
+        const Mif::Handle a = map.emplace("a");
+        const Mif::Handle b = map.emplace("b");
+        const Mif::Handle c = map.emplace("c");
+
+        EXPECT_EQ(map.size(), 3);
+        EXPECT_EQ(map[a], "a");
+        EXPECT_EQ(*map.get(c), "c");
+        EXPECT_EQ(map.get(Mif::Handle()), nullptr);
+
+        map.erase(a);
+
+        EXPECT_EQ(map.size(), 2);
+        EXPECT_FALSE(map.contains(a));
+        EXPECT_EQ(map.get(a), nullptr);
+        EXPECT_EQ(map[b], "b");
+        EXPECT_EQ(map[c], "c");
+
+        // the slot comes back with a new generation, so a stays stale
+        const Mif::Handle d = map.emplace("d");
+        EXPECT_EQ(d.index(), a.index());
+        EXPECT_NE(d.generation(), a.generation());
+        EXPECT_FALSE(map.contains(a));
+        EXPECT_EQ(map[d], "d");
+    }
+
+
+    TEST(SlotMapTest, denseIteration)
+    {
+        Mif::SlotMap<int> map;
+        std::vector<Mif::Handle> handles;
+
+        for (uint32_t i = 0; i < kNumObjects; i++)
+        {
+            handles.push_back(map.emplace(i));
+        }
+
+        // erase every other object
+        for (uint32_t i = 0; i < kNumObjects; i += 2)
+        {
+            map.erase(handles[i]);
+        }
+
+        EXPECT_EQ(map.size(), kNumObjects / 2);
+        EXPECT_EQ(map.end() - map.begin(), kNumObjects / 2);
+
+        std::set<int> values(map.begin(), map.end());
+
+        for (uint32_t i = 0; i < kNumObjects; i++)
+        {
+            EXPECT_EQ(values.count(i), i % 2);
+            EXPECT_EQ(map.contains(handles[i]), i % 2 == 1);
+        }
+
+        for (uint32_t i = 0; i < map.size(); i++)
+        {
+            EXPECT_EQ(map[map.handleAt(i)], map.begin()[i]);
+        }
+    }
+
+
+    TEST(SlotMapTest, destroyOnce)
+    {
+        {
+            Mif::SlotMap<Tracked> map;
+
+            const Mif::Handle a = map.emplace(1);
+            map.emplace(2);
+            map.emplace(3);
+            EXPECT_EQ(Tracked::alive, 3);
+
+            map.erase(a);
+            EXPECT_EQ(Tracked::alive, 2);
+        }
+
+        EXPECT_EQ(Tracked::alive, 0);
+    }
+
+
+    TEST(HandleTableTest, reuseAndStale)
+    {
+        Mif::HandleTable table;
+
+        const Mif::Handle a = table.create();
+        const Mif::Handle b = table.create();
+
+        EXPECT_EQ(table.indexOf(a), 0);
+        EXPECT_EQ(table.indexOf(b), 1);
+
+        EXPECT_EQ(table.destroy(a), 0);
+
+        // b moved into the freed dense index
+        EXPECT_EQ(table.indexOf(b), 0);
+        EXPECT_EQ(table.handleAt(0), b);
+        EXPECT_FALSE(table.valid(a));
+        EXPECT_FALSE(table.valid(Mif::Handle(a.index(), a.generation() + 1)));
+
+        for (uint32_t i = 0; i < 10; i++)
+        {
+            const Mif::Handle h = table.create();
+            EXPECT_EQ(h.index(), a.index());
+            table.destroy(h);
+            EXPECT_FALSE(table.valid(h));
+        }
+
+        EXPECT_TRUE(table.valid(b));
+        EXPECT_EQ(table.size(), 1);
+    }
+
+} // namespace anonymouse
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <tuple>
+
+namespace Mif {
+
+    // Subject whose observer set is fixed at compile time.
+    // notify<kEvent>() expands into one direct call per observer, so there is
+    // no virtual call and no loop; each call can be inlined, and an observer
+    // that ignores kEvent compiles down to nothing.
+    //
+    // Observers are held by reference and must provide
+    //     template <Event kEvent> void onNotify(const Entity& entity);
+    template <typename Entity, typename Event, typename... Observers>
+    class StaticSubject {
+    public:
+        explicit StaticSubject(Observers&... observers)
+        : m_observers(observers...)
+        {
+            ;
+        }
+
+        template <Event kEvent>
+        void notify(const Entity& entity)
+        {
+            std::apply([&entity](Observers&... observers) {
+                (observers.template onNotify<kEvent>(entity), ...);
+            }, m_observers);
+        }
+
+        template <size_t kIndex>
+        auto& get() { return std::get<kIndex>(m_observers); }
+
+        static constexpr size_t numObservers() { return sizeof...(Observers); }
+
+    private:
+        std::tuple<Observers&...> m_observers;
+    };
+
+
+    template <typename Entity, typename Event, typename... Observers>
+    StaticSubject<Entity, Event, Observers...> makeStaticSubject(Observers&... observers)
+    {
+        return StaticSubject<Entity, Event, Observers...>(observers...);
+    }
+
+} // namespace Mif
@@ -0,0 +1,100 @@
+#include <cstdio>
+#include <string>
+#include "static_subject.h"
+#include "gtest/gtest.h"
+
+namespace { // for constants
+    enum TestEvent {
+        TEST_EVENT_A = 0,
+        TEST_EVENT_B,
+    };
+
+    struct TestEntity
+    {
+        int id;
+    };
+
+    // appends "<tag><id>" for every event it handles, to check call order
+    class Recorder
+    {
+    public:
+        Recorder(std::string& log, char tag)
+            : log_(log)
+            , tag_(tag)
+        {}
+
+        template <TestEvent event>
+        void onNotify(const TestEntity& entity)
+        {
+            log_ += tag_;
+            log_ += std::to_string(entity.id);
+        }
+
+    private:
+        std::string& log_;
+        char tag_;
+    };
+
+    // only reacts to TEST_EVENT_B
+    class Filter
+    {
+    public:
+        Filter() : count_(0) {}
+
+        template <TestEvent event>
+        void onNotify(const TestEntity&)
+        {
+            if constexpr (event == TEST_EVENT_B)
+                count_++;
+        }
+
+        int count_;
+    };
+} // namespace anonymouse
+
+
+namespace { // for functions
+
+    TEST(StaticSubjectTest, callOrder)
+    {
+        std::string log;
+        Recorder a(log, 'a');
+        Recorder b(log, 'b');
+
+        auto subject = Mif::makeStaticSubject<TestEntity, TestEvent>(a, b);
+        EXPECT_EQ(subject.numObservers(), 2);
+
+        subject.notify<TEST_EVENT_A>(TestEntity{ 1 });
+        subject.notify<TEST_EVENT_B>(TestEntity{ 2 });
+
+        EXPECT_EQ(log, "a1b1a2b2");
+    }
+
+
+    TEST(StaticSubjectTest, compileTimeEvent)
+    {
+        std::string log;
+        Recorder recorder(log, 'r');
+        Filter filter;
+
+        Mif::StaticSubject<TestEntity, TestEvent, Filter, Recorder> subject(filter, recorder);
+
+        subject.notify<TEST_EVENT_A>(TestEntity{ 0 });
+        subject.notify<TEST_EVENT_B>(TestEntity{ 0 });
+        subject.notify<TEST_EVENT_B>(TestEntity{ 0 });
+
+        EXPECT_EQ(filter.count_, 2);
+        EXPECT_EQ(&subject.get<0>(), &filter);
+        EXPECT_EQ(log, "r0r0r0");
+    }
+
+
+    TEST(StaticSubjectTest, noObservers)
+    {
+        auto subject = Mif::makeStaticSubject<TestEntity, TestEvent>();
+
+        EXPECT_EQ(subject.numObservers(), 0);
+        subject.notify<TEST_EVENT_A>(TestEntity{ 0 });
+    }
+
+} // namespace anonymouse
@@ -0,0 +1,117 @@
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include "surface_grid.h"
+
+namespace Mif {
+
+    SurfaceGrid::SurfaceGrid(float minX, float maxX, float cellWidth, float groundY)
+    : m_minX(minX)
+    , m_invCellWidth(1.0f / cellWidth)
+    , m_groundY(groundY)
+    , m_numColumns(static_cast<uint32_t>(std::ceil((maxX - minX) / cellWidth)))
+    , m_built(false)
+    {
+        assert(maxX > minX && cellWidth > 0.0f && "invalid grid extent");
+    }
+
+
+    void SurfaceGrid::add(const Surface& surface)
+    {
+        assert(surface.x0 <= surface.x1 && "surface must span left to right");
+
+        m_surfaces.push_back(surface);
+        m_built = false;
+    }
+
+
+    void SurfaceGrid::build()
+    {
+        // highest first, so a query can stop at the first match
+        std::vector<Surface> sorted = m_surfaces;
+        std::sort(sorted.begin(), sorted.end(), [](const Surface& a, const Surface& b) {
+            return a.y > b.y;
+        });
+
+        std::vector<uint32_t> counts(m_numColumns, 0);
+
+        for (const Surface& s : sorted)
+        {
+            for (uint32_t c = columnOf(s.x0); c <= columnOf(s.x1); c++)
+            {
+                counts[c]++;
+            }
+        }
+
+        m_columnStart.assign(m_numColumns + 1, 0);
+
+        for (uint32_t c = 0; c < m_numColumns; c++)
+        {
+            m_columnStart[c + 1] = m_columnStart[c] + counts[c];
+        }
+
+        m_columnSurfaces.resize(m_columnStart[m_numColumns]);
+
+        std::vector<uint32_t> cursor(m_columnStart.begin(), m_columnStart.end() - 1);
+
+        for (const Surface& s : sorted)
+        {
+            for (uint32_t c = columnOf(s.x0); c <= columnOf(s.x1); c++)
+            {
+                m_columnSurfaces[cursor[c]++] = s;
+            }
+        }
+
+        m_built = true;
+    }
+
+
+    uint32_t SurfaceGrid::columnOf(float x) const
+    {
+        const float cell = (x - m_minX) * m_invCellWidth;
+
+        if (!(cell > 0.0f))
+            return 0;
+
+        return std::min(static_cast<uint32_t>(cell), m_numColumns - 1);
+    }
+
+
+    float SurfaceGrid::floorAt(float x, float y) const
+    {
+        assert(m_built && "build() must be called after add()");
+
+        const uint32_t c = columnOf(x);
+        const Surface* it = m_columnSurfaces.data() + m_columnStart[c];
+        const Surface* const end = m_columnSurfaces.data() + m_columnStart[c + 1];
+
+        for (; it != end; ++it)
+        {
+            if (it->y <= y + kContactEpsilon && x >= it->x0 && x <= it->x1)
+                return std::max(it->y, m_groundY);
+        }
+
+        return m_groundY;
+    }
+
+
+    void SurfaceGrid::queryFloors(const float* x, const float* y, uint32_t count, float* floor) const
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            floor[i] = floorAt(x[i], y[i]);
+        }
+    }
+
+
+    uint32_t stepEntities(EntityStore& store, const SurfaceGrid& grid, float dt, ChangeTracker& tracker)
+    {
+        grid.queryFloors(store.posX(), store.posY(), store.size(), store.floor());
+
+        tracker.capture(store);
+        store.updateAll(dt);
+
+        return tracker.detect(store);
+    }
+
+} // namespace Mif
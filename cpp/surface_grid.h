@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "entity_store.h"
+#include "change_tracker.h"
+
+// reference: http://gameprogrammingpatterns.com/spatial-partition.html
+
+namespace Mif {
+
+    // horizontal platform an entity can stand on
+    struct Surface {
+        float x0;
+        float x1;
+        float y;
+    };
+
+    // Uniform grid of x columns over a set of surfaces.
+    // Each column keeps a copy of the surfaces overlapping it, sorted from
+    // the highest down, in one contiguous array (CSR layout), so a query
+    // touches a single short run of memory and no other surfaces.
+    class SurfaceGrid {
+    public:
+        // entities outside [minX, maxX) use the outermost column;
+        // groundY is the floor where no surface is found
+        SurfaceGrid(float minX, float maxX, float cellWidth, float groundY = 0.0f);
+
+        void add(const Surface& surface);
+
+        // rebuilds the columns, needed after add() and before any query
+        void build();
+
+        // height of the highest surface at or below (x, y)
+        float floorAt(float x, float y) const;
+
+        // whether (x, y) rests on a surface (or the ground)
+        bool onSurface(float x, float y) const { return y <= floorAt(x, y) + kContactEpsilon; }
+
+        // floorAt() over arrays
+        void queryFloors(const float* x, const float* y, uint32_t count, float* floor) const;
+
+        uint32_t numSurfaces() const { return static_cast<uint32_t>(m_surfaces.size()); }
+        uint32_t numColumns() const { return m_numColumns; }
+
+        static constexpr float kContactEpsilon = 1e-3f;
+
+    private:
+        uint32_t columnOf(float x) const;
+
+        const float m_minX;
+        const float m_invCellWidth;
+        const float m_groundY;
+        const uint32_t m_numColumns;
+        bool m_built;
+
+        std::vector<Surface> m_surfaces;
+        std::vector<uint32_t> m_columnStart;   // numColumns + 1 offsets into m_columnSurfaces
+        std::vector<Surface> m_columnSurfaces;
+    };
+
+
+    // One simulation step over an EntityStore with surface contact:
+    // refreshes every floor from the grid, integrates, and appends the
+    // entities that landed or left a surface to tracker.changes().
+    // Entities that did not change state are not reported.
+    uint32_t stepEntities(EntityStore& store, const SurfaceGrid& grid, float dt, ChangeTracker& tracker);
+
+} // namespace Mif
@@ -0,0 +1,114 @@
+#include <cstdio>
+#include <vector>
+#include "surface_grid.h"
+#include "gtest/gtest.h"
+
+namespace { // for constants
+    const float kGround = -1.0f;
+    const float kTimeStep = 0.1f;
+} // namespace anonymouse
+
+namespace { // for test fixture
+    class SurfaceGridTest : public ::testing::Test
+    {
+    public:
+        void SetUp();
+        void TearDown();
+
+        Mif::SurfaceGrid* grid_;
+    };
+
+    void SurfaceGridTest::SetUp()
+    {
+        grid_ = new Mif::SurfaceGrid(0.0f, 100.0f, 8.0f, kGround);
+
+        grid_->add(Mif::Surface{ 10.0f, 30.0f, 5.0f });   // bridge
+        grid_->add(Mif::Surface{ 20.0f, 25.0f, 10.0f });  // ledge above the bridge
+        grid_->add(Mif::Surface{ 90.0f, 200.0f, 2.0f });  // runs past the grid
+        grid_->build();
+    }
+
+    void SurfaceGridTest::TearDown()
+    {
+        delete(grid_);
+    }
+} // namespace anonymouse
+
+
+namespace { // for functions
+
+    TEST_F(SurfaceGridTest, floorAt)
+    {
+        EXPECT_EQ(grid_->numSurfaces(), 3);
+        EXPECT_EQ(grid_->numColumns(), 13);
+
+        EXPECT_FLOAT_EQ(grid_->floorAt(5.0f, 50.0f), kGround);
+        EXPECT_FLOAT_EQ(grid_->floorAt(15.0f, 50.0f), 5.0f);
+        EXPECT_FLOAT_EQ(grid_->floorAt(22.0f, 50.0f), 10.0f);
+        EXPECT_FLOAT_EQ(grid_->floorAt(22.0f, 7.0f), 5.0f);   // below the ledge
+        EXPECT_FLOAT_EQ(grid_->floorAt(22.0f, 3.0f), kGround); // below the bridge
+        EXPECT_FLOAT_EQ(grid_->floorAt(30.0f, 5.0f), 5.0f);   // right edge
+        EXPECT_FLOAT_EQ(grid_->floorAt(31.0f, 5.0f), kGround);
+
+        // outside the grid extent uses the outermost columns
+        EXPECT_FLOAT_EQ(grid_->floorAt(150.0f, 3.0f), 2.0f);
+        EXPECT_FLOAT_EQ(grid_->floorAt(-10.0f, 3.0f), kGround);
+    }
+
+
+    TEST_F(SurfaceGridTest, onSurface)
+    {
+        EXPECT_TRUE(grid_->onSurface(15.0f, 5.0f));
+        EXPECT_TRUE(grid_->onSurface(15.0f, 5.0f + Mif::SurfaceGrid::kContactEpsilon / 2));
+        EXPECT_FALSE(grid_->onSurface(15.0f, 5.1f));
+        EXPECT_TRUE(grid_->onSurface(50.0f, kGround));
+    }
+
+
+    TEST_F(SurfaceGridTest, queryFloors)
+    {
+        const float x[] = { 5.0f, 15.0f, 22.0f, 95.0f };
+        const float y[] = { 1.0f, 6.0f, 11.0f, 3.0f };
+        float floor[4];
+
+        grid_->queryFloors(x, y, 4, floor);
+
+        EXPECT_FLOAT_EQ(floor[0], kGround);
+        EXPECT_FLOAT_EQ(floor[1], 5.0f);
+        EXPECT_FLOAT_EQ(floor[2], 10.0f);
+        EXPECT_FLOAT_EQ(floor[3], 2.0f);
+    }
+
+
+    TEST_F(SurfaceGridTest, stepReportsOnlyTransitions)
+    {
+        Mif::EntityStore store;
+
+        const Mif::EntityId walker = store.create(29.5f, 5.0f);  // walks off the bridge
+        const Mif::EntityId stander = store.create(15.0f, 5.0f); // stays on the bridge
+        const Mif::EntityId faller = store.create(50.0f, 20.0f); // already in the air
+
+        store.velX()[store.indexOf(walker)] = 10.0f;
+
+        Mif::ChangeTracker tracker;
+
+        // first step settles walker and stander on the bridge
+        EXPECT_EQ(Mif::stepEntities(store, *grid_, 0.0f, tracker), 2);
+        EXPECT_EQ(tracker.changes()[0].transition, Mif::Transition::LANDED);
+        EXPECT_EQ(tracker.changes()[1].transition, Mif::Transition::LANDED);
+        tracker.clearChanges();
+
+        for (int tick = 0; tick < 10; tick++)
+        {
+            store.accelerateAll(-10.0f, kTimeStep);
+            Mif::stepEntities(store, *grid_, kTimeStep, tracker);
+        }
+
+        ASSERT_EQ(tracker.changes().size(), 1);
+        EXPECT_EQ(tracker.changes()[0].entity, walker);
+        EXPECT_EQ(tracker.changes()[0].transition, Mif::Transition::LEFT_SURFACE);
+        EXPECT_EQ(store.onSurface()[store.indexOf(stander)], 1);
+        EXPECT_EQ(store.onSurface()[store.indexOf(faller)], 0);
+    }
+
+} // namespace anonymouse
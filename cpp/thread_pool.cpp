@@ -0,0 +1,178 @@
+#include <cassert>
+#include "thread_pool.h"
+
+namespace Mif {
+
+    namespace {
+        const uint32_t kNoWorker = ~0u;
+
+        // index of the pool worker running on this thread, if any
+        thread_local const ThreadPool* t_pool = nullptr;
+        thread_local uint32_t t_index = kNoWorker;
+    } // namespace anonymouse
+
+
+    ThreadPool::ThreadPool(uint32_t numThreads)
+    : m_nextQueue(0)
+    , m_pending(0)
+    , m_stop(false)
+    {
+        assert(numThreads > 0 && "thread pool needs at least one worker");
+
+        for (uint32_t i = 0; i < numThreads; i++)
+        {
+            m_workers.emplace_back(new Worker());
+        }
+
+        for (uint32_t i = 0; i < numThreads; i++)
+        {
+            m_threads.emplace_back(&ThreadPool::run, this, i);
+        }
+    }
+
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_stop = true;
+        }
+        m_sleep.notify_all();
+
+        for (std::thread& t : m_threads)
+        {
+            t.join();
+        }
+    }
+
+
+    void ThreadPool::submit(const Task& task)
+    {
+        if (task.group)
+            task.group->add(1);
+
+        const uint32_t index = (t_pool == this)
+            ? t_index
+            : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % numThreads();
+
+        {
+            Worker& worker = *m_workers[index];
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            worker.tasks.push_back(task);
+        }
+
+        m_pending.fetch_add(1, std::memory_order_release);
+
+        {
+            // pairs with the predicate check in run(), so a worker about
+            // to sleep cannot miss this task
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+        }
+        m_sleep.notify_one();
+    }
+
+
+    void ThreadPool::wait(WaitGroup& group)
+    {
+        const uint32_t index = (t_pool == this) ? t_index : kNoWorker;
+
+        while (!group.finished())
+        {
+            if (!runOne(index))
+                std::this_thread::yield();
+        }
+    }
+
+
+    void ThreadPool::run(uint32_t index)
+    {
+        t_pool = this;
+        t_index = index;
+
+        for (;;)
+        {
+            if (runOne(index))
+                continue;
+
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_sleep.wait(lock, [this]() {
+                return m_stop || m_pending.load(std::memory_order_acquire) > 0;
+            });
+
+            if (m_stop && m_pending.load(std::memory_order_acquire) == 0)
+                break;
+        }
+
+        t_pool = nullptr;
+        t_index = kNoWorker;
+    }
+
+
+    bool ThreadPool::popLocal(uint32_t index, Task& task)
+    {
+        Worker& worker = *m_workers[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+
+        if (worker.tasks.empty())
+            return false;
+
+        task = worker.tasks.back();
+        worker.tasks.pop_back();
+
+        return true;
+    }
+
+
+    bool ThreadPool::steal(uint32_t thief, Task& task)
+    {
+        const uint32_t n = numThreads();
+        const uint32_t start = (thief == kNoWorker) ? 0 : thief + 1;
+
+        for (uint32_t i = 0; i < n; i++)
+        {
+            const uint32_t victim = (start + i) % n;
+
+            if (victim == thief)
+                continue;
+
+            Worker& worker = *m_workers[victim];
+            std::lock_guard<std::mutex> lock(worker.mutex);
+
+            if (worker.tasks.empty())
+                continue;
+
+            task = worker.tasks.front();
+            worker.tasks.pop_front();
+
+            return true;
+        }
+
+        return false;
+    }
+
+
+    bool ThreadPool::runOne(uint32_t index)
+    {
+        Task task;
+
+        const bool found = (index != kNoWorker && popLocal(index, task)) || steal(index, task);
+
+        if (!found)
+            return false;
+
+        m_pending.fetch_sub(1, std::memory_order_relaxed);
+        execute(task);
+
+        return true;
+    }
+
+
+    void ThreadPool::execute(const Task& task)
+    {
+        task.func(task.arg);
+
+        if (task.group)
+            task.group->done();
+    }
+
+} // namespace Mif
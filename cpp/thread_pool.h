@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// reference: http://supertech.csail.mit.edu/papers/steal.pdf
+
+namespace Mif {
+
+    // Completion barrier for a batch of tasks.
+    class WaitGroup {
+    public:
+        WaitGroup() : m_count(0) {}
+
+        void add(uint32_t n) { m_count.fetch_add(n, std::memory_order_relaxed); }
+        bool finished() const { return m_count.load(std::memory_order_acquire) == 0; }
+
+        void done()
+        {
+            if (m_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                m_count.notify_all();
+        }
+
+        // blocks until the group is finished, without running anything
+        void wait() const
+        {
+            for (uint32_t count; (count = m_count.load(std::memory_order_acquire)) != 0; )
+            {
+                m_count.wait(count, std::memory_order_acquire);
+            }
+        }
+
+    private:
+        std::atomic<uint32_t> m_count;
+    };
+
+
+    typedef void (*TaskFunc)(void* arg);
+
+    struct Task {
+        TaskFunc func;
+        void* arg;
+        WaitGroup* group;  // may be null
+    };
+
+
+    // Fixed set of workers, each with its own deque.
+    // A worker pops its own deque from the back (LIFO, cache warm) and
+    // steals from the front of the others when it runs dry.
+    class ThreadPool {
+    public:
+        explicit ThreadPool(uint32_t numThreads);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // pushes to the calling worker's deque, or round-robin from other threads
+        void submit(const Task& task);
+
+        // runs pending tasks on the calling thread until the group is finished
+        void wait(WaitGroup& group);
+
+        uint32_t numThreads() const { return static_cast<uint32_t>(m_workers.size()); }
+
+    private:
+        struct alignas(64) Worker {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        void run(uint32_t index);
+        bool popLocal(uint32_t index, Task& task);
+        bool steal(uint32_t thief, Task& task);
+        bool runOne(uint32_t index);
+        static void execute(const Task& task);
+
+        std::vector<std::unique_ptr<Worker>> m_workers;
+        std::vector<std::thread> m_threads;
+
+        std::atomic<uint32_t> m_nextQueue;
+        std::atomic<uint32_t> m_pending;
+        std::atomic<bool> m_stop;
+
+        std::mutex m_sleepMutex;
+        std::condition_variable m_sleep;
+    };
+
+} // namespace Mif
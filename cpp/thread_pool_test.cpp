@@ -0,0 +1,117 @@
+#include <cstdio>
+#include <atomic>
+#include <vector>
+#include "thread_pool.h"
+#include "gtest/gtest.h"
+
+namespace { // for constants
+    const uint32_t kNumThreads = 4;
+    const uint32_t kNumTasks = 1000;
+
+    struct Counter
+    {
+        std::atomic<uint32_t> value;
+    };
+
+    void increment(void* arg)
+    {
+        static_cast<Counter*>(arg)->value.fetch_add(1);
+    }
+
+    struct Fork
+    {
+        Mif::ThreadPool* pool;
+        Mif::WaitGroup* group;
+        Counter* counter;
+        uint32_t depth;
+    };
+
+    // every task forks two children until the depth runs out
+    void fork(void* arg)
+    {
+        Fork* const parent = static_cast<Fork*>(arg);
+        parent->counter->value.fetch_add(1);
+
+        if (parent->depth == 0)
+            return;
+
+        Fork children[2];
+        Mif::WaitGroup group;
+
+        for (Fork& child : children)
+        {
+            child = *parent;
+            child.group = &group;
+            child.depth = parent->depth - 1;
+
+            const Mif::Task task = { fork, &child, &group };
+            parent->pool->submit(task);
+        }
+
+        parent->pool->wait(group);
+    }
+} // namespace anonymouse
+
+
+namespace { // for functions
+
+    TEST(ThreadPoolTest, waitGroup)
+    {
+        Mif::ThreadPool pool(kNumThreads);
+        Mif::WaitGroup group;
+        Counter counter;
+        counter.value = 0;
+
+        EXPECT_EQ(pool.numThreads(), kNumThreads);
+        EXPECT_TRUE(group.finished());
+
+        for (uint32_t i = 0; i < kNumTasks; i++)
+        {
+            const Mif::Task task = { increment, &counter, &group };
+            pool.submit(task);
+        }
+
+        pool.wait(group);
+
+        EXPECT_TRUE(group.finished());
+        EXPECT_EQ(counter.value.load(), kNumTasks);
+    }
+
+
+    TEST(ThreadPoolTest, nestedSubmit)
+    {
+        const uint32_t kDepth = 8;
+
+        Mif::ThreadPool pool(kNumThreads);
+        Mif::WaitGroup group;
+        Counter counter;
+        counter.value = 0;
+
+        Fork root = { &pool, &group, &counter, kDepth };
+        const Mif::Task task = { fork, &root, &group };
+        pool.submit(task);
+        pool.wait(group);
+
+        EXPECT_EQ(counter.value.load(), (1u << (kDepth + 1)) - 1);
+    }
+
+
+    TEST(ThreadPoolTest, destroyWithPendingTasks)
+    {
+        Counter counter;
+        counter.value = 0;
+
+        {
+            Mif::ThreadPool pool(1);
+
+            for (uint32_t i = 0; i < kNumTasks; i++)
+            {
+                const Mif::Task task = { increment, &counter, nullptr };
+                pool.submit(task);
+            }
+        }
+
+        EXPECT_EQ(counter.value.load(), kNumTasks);
+    }
+
+} // namespace anonymouse
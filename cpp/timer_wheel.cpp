@@ -0,0 +1,246 @@
+#include <cassert>
+#include <new>
+#include "timer_wheel.h"
+
+namespace Mif {
+
+    // list links come first so a List head can stand in for a node
+    struct TimerNode {
+        TimerNode* prev;
+        TimerNode* next;
+        uint64_t expiry;
+        uint32_t generation;
+        bool pending;
+        TimerCallback callback;
+    };
+
+    struct TimerWheel::List {
+        TimerNode* prev;
+        TimerNode* next;
+
+        TimerNode* head() { return reinterpret_cast<TimerNode*>(this); }
+        bool empty() { return next == head(); }
+        void init() { prev = next = head(); }
+
+        void pushBack(TimerNode* node)
+        {
+            node->prev = prev;
+            node->next = head();
+            prev->next = node;
+            prev = node;
+        }
+
+        // moves every node of other to the end of this list
+        void splice(List& other)
+        {
+            if (other.empty())
+                return;
+
+            other.next->prev = prev;
+            other.prev->next = head();
+            prev->next = other.next;
+            prev = other.prev;
+            other.init();
+        }
+    };
+
+    namespace {
+        void unlink(TimerNode* node)
+        {
+            node->prev->next = node->next;
+            node->next->prev = node->prev;
+        }
+
+        const uint64_t kSlotMask = TimerWheel::kNumSlots - 1;
+        const uint64_t kMaxDelta = (uint64_t(1) << (TimerWheel::kSlotBits * TimerWheel::kNumLevels)) - 1;
+    } // namespace anonymouse
+
+
+    TimerWheel::TimerWheel(uint64_t now)
+    : m_now(now)
+    , m_numPending(0)
+    , m_generation(0)
+    , m_pool(sizeof(TimerNode), 1024)
+    , m_slots(new List[kNumLevels * kNumSlots + 1])
+    , m_expiring(m_slots + kNumLevels * kNumSlots)
+    {
+        for (uint32_t i = 0; i <= kNumLevels * kNumSlots; i++)
+        {
+            m_slots[i].init();
+        }
+    }
+
+
+    TimerWheel::~TimerWheel()
+    {
+        for (uint32_t i = 0; i <= kNumLevels * kNumSlots; i++)
+        {
+            while (!m_slots[i].empty())
+            {
+                TimerNode* const node = m_slots[i].next;
+                unlink(node);
+                node->~TimerNode();
+                m_pool.free(node);
+            }
+        }
+
+        delete[] m_slots;
+    }
+
+
+    TimerId TimerWheel::schedule(uint64_t tick, TimerCallback callback)
+    {
+        TimerNode* const node = static_cast<TimerNode*>(m_pool.alloc());
+        new (node) TimerNode{ nullptr, nullptr, tick, ++m_generation, true, static_cast<TimerCallback&&>(callback) };
+
+        // the slot of the current tick has already fired
+        place(node, m_now + 1);
+        m_numPending++;
+
+        return TimerId{ node, node->generation };
+    }
+
+
+    TimerId TimerWheel::schedule(uint64_t tick, CallbackFunc callback, const char* arg)
+    {
+        return schedule(tick, TimerCallback([callback, arg]() { callback(arg); }));
+    }
+
+
+    bool TimerWheel::cancel(TimerId id)
+    {
+        TimerNode* const node = id.node;
+
+        // nodes go back to the pool, never to the system, so this read is safe
+        if (node == nullptr || node->generation != id.generation || !node->pending)
+            return false;
+
+        unlink(node);
+        node->pending = false;
+        node->~TimerNode();
+        m_pool.free(node);
+        m_numPending--;
+
+        return true;
+    }
+
+
+    void TimerWheel::place(TimerNode* node, uint64_t earliest)
+    {
+        const uint64_t expiry = node->expiry > earliest ? node->expiry : earliest;
+        const uint64_t delta = expiry - m_now;
+        const uint64_t slotTick = delta > kMaxDelta ? m_now + kMaxDelta : expiry;
+
+        uint32_t level = 0;
+
+        while (level + 1 < kNumLevels && delta >= (uint64_t(1) << (kSlotBits * (level + 1))))
+        {
+            level++;
+        }
+
+        const uint32_t index = static_cast<uint32_t>((slotTick >> (kSlotBits * level)) & kSlotMask);
+        m_slots[level * kNumSlots + index].pushBack(node);
+    }
+
+
+    void TimerWheel::cascade(uint32_t level)
+    {
+        const uint32_t index = static_cast<uint32_t>((m_now >> (kSlotBits * level)) & kSlotMask);
+
+        List batch;
+        batch.init();
+        batch.splice(m_slots[level * kNumSlots + index]);
+
+        while (!batch.empty())
+        {
+            TimerNode* const node = batch.next;
+            unlink(node);
+            place(node, m_now);
+        }
+
+        if (index == 0 && level + 1 < kNumLevels)
+            cascade(level + 1);
+    }
+
+
+    uint32_t TimerWheel::tick()
+    {
+        m_now++;
+
+        // the higher levels are redistributed before this tick's slot fires
+        if ((m_now & kSlotMask) == 0)
+            cascade(1);
+
+        m_expiring->splice(m_slots[m_now & kSlotMask]);
+
+        uint32_t fired = 0;
+
+        while (!m_expiring->empty())
+        {
+            TimerNode* const node = m_expiring->next;
+            unlink(node);
+            m_numPending--;
+            assert(node->expiry <= m_now && "timer fired early");
+
+            // a callback cancelling its own timer now finds it not pending
+            node->pending = false;
+            node->callback();
+            node->~TimerNode();
+            m_pool.free(node);
+            fired++;
+        }
+
+        return fired;
+    }
+
+
+    uint64_t TimerWheel::nextEventTick()
+    {
+        uint64_t next = ~uint64_t(0);
+
+        // level 0 acts on every tick, level L only on multiples of 256^L,
+        // where it redistributes the slot of that tick
+        for (uint32_t level = 0; level < kNumLevels; level++)
+        {
+            const uint32_t shift = kSlotBits * level;
+            const uint64_t step = uint64_t(1) << shift;
+            uint64_t t = ((m_now >> shift) + 1) << shift;
+
+            for (uint32_t i = 0; i < kNumSlots && t < next; i++, t += step)
+            {
+                if (!m_slots[level * kNumSlots + ((t >> shift) & kSlotMask)].empty())
+                {
+                    next = t;
+                    break;
+                }
+            }
+        }
+
+        return next;
+    }
+
+
+    uint32_t TimerWheel::advance(uint64_t ticks)
+    {
+        const uint64_t end = m_now + ticks;
+        uint32_t fired = 0;
+
+        while (m_now < end)
+        {
+            // ticks whose slots are all empty would do nothing: skip them
+            const uint64_t next = (m_numPending == 0) ? end + 1 : nextEventTick();
+
+            if (next > end)
+            {
+                m_now = end;
+                break;
+            }
+
+            m_now = next - 1;
+            fired += tick();
+        }
+
+        return fired;
+    }
+
+} // namespace Mif
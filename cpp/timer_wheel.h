@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include "callback_registry.h"  // CallbackFunc
+#include "delegate.h"
+#include "memory_allocator.h"
+
+namespace Mif {
+
+    typedef Delegate<void()> TimerCallback;
+
+    struct TimerNode;
+
+    // identifies one scheduling; stays safe to cancel after the timer fired
+    struct TimerId {
+        TimerNode* node;
+        uint32_t generation;
+    };
+
+
+    // Hierarchical timing wheel.
+    //
+    // Four levels of 256 slots each, every level covering 256 times the span
+    // of the one below: level 0 holds the timers of the next 256 ticks, one
+    // slot per tick, level 1 the next 65536 ticks, 256 ticks per slot, and
+    // so on. Each slot is an intrusive list, so schedule() and cancel() are
+    // O(1). When level 0 wraps, the next slot of level 1 is redistributed
+    // into level 0 (and level 2 into level 1 when level 1 wraps, ...), so a
+    // timer is moved at most once per level. A tick expires its whole slot
+    // as one batch.
+    //
+    // Timers further away than 2^32 ticks wait in the top level and are
+    // placed again each time it comes round.
+    //
+    // advance() jumps over ticks on which every slot it would touch is
+    // empty, so idle stretches cost at most one scan of each level.
+    //
+    // Timer nodes come from a PoolAllocator and are reused after they fire
+    // or are cancelled.
+    class TimerWheel {
+    public:
+        static const uint32_t kSlotBits = 8;
+        static const uint32_t kNumSlots = 1 << kSlotBits;
+        static const uint32_t kNumLevels = 4;
+
+        explicit TimerWheel(uint64_t now = 0);
+        ~TimerWheel();
+
+        TimerWheel(const TimerWheel&) = delete;
+        TimerWheel& operator=(const TimerWheel&) = delete;
+
+        // runs callback once the wheel reaches tick; a tick that has already
+        // passed fires on the next advance()
+        TimerId schedule(uint64_t tick, TimerCallback callback);
+        TimerId scheduleAfter(uint64_t delay, TimerCallback callback) { return schedule(m_now + delay, static_cast<TimerCallback&&>(callback)); }
+
+        // FUNC_POINTER style callback, called with arg
+        TimerId schedule(uint64_t tick, CallbackFunc callback, const char* arg);
+
+        // false if the timer already fired or was cancelled
+        bool cancel(TimerId id);
+
+        // moves time forward, firing every timer that comes due; callbacks
+        // may schedule and cancel timers. Returns the number fired.
+        uint32_t advance(uint64_t ticks = 1);
+        uint32_t advanceTo(uint64_t tick) { return tick > m_now ? advance(tick - m_now) : 0; }
+
+        uint64_t now() const { return m_now; }
+        size_t numPending() const { return m_numPending; }
+        uint32_t numNodeChunks() const { return m_pool.getNumChunks(); }
+
+    private:
+        struct List;
+
+        // files node by its expiry, but not before earliest
+        void place(TimerNode* node, uint64_t earliest);
+        void cascade(uint32_t level);
+        uint32_t tick();
+
+        // the first tick after now that fires or redistributes a slot
+        uint64_t nextEventTick();
+
+        uint64_t m_now;
+        size_t m_numPending;
+        uint32_t m_generation;
+        PoolAllocator m_pool;
+        List* m_slots;      // kNumLevels * kNumSlots list heads
+        List* m_expiring;   // the batch being fired
+    };
+
+} // namespace Mif
@@ -0,0 +1,111 @@
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <chrono>
+#include <functional>
+#include <queue>
+#include <vector>
+#include "timer_wheel.h"
+
+using namespace std;
+
+// Schedules kNumTimers timeouts, cancels half of them and runs time until
+// the rest fired: Mif::TimerWheel against a std::priority_queue of
+// std::function with cancelled entries skipped when popped.
+
+#define VPRINTF(...) \
+    do { \
+        printf(__VA_ARGS__); \
+    } while (false)
+
+namespace {
+
+    const uint32_t kNumTimers = 500 * 1000;
+    const uint32_t kMaxDelay = 100 * 1000;
+
+    uint64_t g_fired = 0;
+
+    void onTimeout(const char*) { g_fired++; }
+
+    double benchWheel(const vector<uint32_t>& delays)
+    {
+        const auto start = chrono::steady_clock::now();
+
+        Mif::TimerWheel wheel;
+        vector<Mif::TimerId> ids(delays.size());
+
+        for (size_t i = 0; i < delays.size(); i++)
+        {
+            ids[i] = wheel.schedule(wheel.now() + delays[i], onTimeout, nullptr);
+        }
+
+        for (size_t i = 0; i < delays.size(); i += 2)
+        {
+            wheel.cancel(ids[i]);
+        }
+
+        wheel.advance(kMaxDelay);
+
+        return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / delays.size();
+    }
+
+    double benchHeap(const vector<uint32_t>& delays)
+    {
+        struct Entry {
+            uint64_t expiry;
+            uint32_t id;
+            bool operator>(const Entry& other) const { return expiry > other.expiry; }
+        };
+
+        const auto start = chrono::steady_clock::now();
+
+        priority_queue<Entry, vector<Entry>, greater<Entry>> heap;
+        vector<function<void()>> callbacks(delays.size());
+        vector<bool> cancelled(delays.size(), false);
+
+        for (uint32_t i = 0; i < delays.size(); i++)
+        {
+            callbacks[i] = [] { onTimeout(nullptr); };
+            heap.push(Entry{ delays[i], i });
+        }
+
+        for (size_t i = 0; i < delays.size(); i += 2)
+        {
+            cancelled[i] = true;
+        }
+
+        for (uint64_t now = 1; now <= kMaxDelay; now++)
+        {
+            while (!heap.empty() && heap.top().expiry <= now)
+            {
+                const uint32_t id = heap.top().id;
+                heap.pop();
+
+                if (!cancelled[id])
+                    callbacks[id]();
+            }
+        }
+
+        return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / delays.size();
+    }
+
+} // namespace anonymouse
+
+
+int main()
+{
+    vector<uint32_t> delays(kNumTimers);
+    srand(0);
+
+    for (uint32_t& delay : delays)
+    {
+        delay = 1 + rand() % kMaxDelay;
+    }
+
+    VPRINTF("%u timers, half cancelled, ns per timer\n", kNumTimers);
+    VPRINTF("%-24s %10.1f\n", "TimerWheel", benchWheel(delays));
+    VPRINTF("%-24s %10.1f\n", "priority_queue", benchHeap(delays));
+    VPRINTF("fired %llu\n", static_cast<unsigned long long>(g_fired));
+
+    return 0;
+}
@@ -0,0 +1,127 @@
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+#include "timer_wheel.h"
+#include "gtest/gtest.h"
+
+namespace { // for constants
+    const uint32_t kNumTimers = 20000;
+} // namespace anonymouse
+
+namespace { // for test fixture
+    std::string g_fired;
+
+    void append(const char* s) { g_fired += s; }
+} // namespace anonymouse
+
+
+namespace { // for functions
+
+    TEST(TimerWheelTest, firesOnItsTickAcrossLevels)
+    {
+        Mif::TimerWheel wheel(12345);
+        std::vector<uint64_t> expiry(kNumTimers);
+        std::vector<uint64_t> firedAt(kNumTimers, 0);
+
+        srand(0);
+
+        for (uint32_t i = 0; i < kNumTimers; i++)
+        {
+            // spans levels 0 to 2, with a few exact slot boundaries
+            const uint64_t delay = (i % 100 == 0) ? (uint64_t(1) << (8 * (i % 3))) : 1 + rand() % (1 << 18);
+            expiry[i] = wheel.now() + delay;
+
+            wheel.scheduleAfter(delay, [&wheel, &firedAt, i]() { firedAt[i] = wheel.now(); });
+        }
+
+        EXPECT_EQ(wheel.numPending(), kNumTimers);
+        EXPECT_EQ(wheel.advance(1 << 18), kNumTimers);
+        EXPECT_EQ(wheel.numPending(), 0);
+
+        for (uint32_t i = 0; i < kNumTimers; i++)
+        {
+            ASSERT_EQ(firedAt[i], expiry[i]) << "timer " << i;
+        }
+    }
+
+
+    TEST(TimerWheelTest, beyondTopLevel)
+    {
+        Mif::TimerWheel wheel;
+        uint64_t firedAt = 0;
+
+        const uint64_t deadline = (uint64_t(1) << 33) + 7;
+        wheel.schedule(deadline, [&wheel, &firedAt]() { firedAt = wheel.now(); });
+
+        // idle ticks are skipped even while the timer is pending
+        EXPECT_EQ(wheel.advanceTo(deadline - 1), 0);
+        EXPECT_EQ(wheel.numPending(), 1);
+        EXPECT_EQ(wheel.advance(), 1);
+        EXPECT_EQ(firedAt, deadline);
+
+        // likewise across a long wait
+        wheel.schedule(deadline * 3, [&wheel, &firedAt]() { firedAt = wheel.now(); });
+        EXPECT_EQ(wheel.advanceTo(deadline * 4), 1);
+        EXPECT_EQ(firedAt, deadline * 3);
+        EXPECT_EQ(wheel.now(), deadline * 4);
+    }
+
+
+    TEST(TimerWheelTest, cancel)
+    {
+        g_fired.clear();
+
+        Mif::TimerWheel wheel;
+        const Mif::TimerId a = wheel.schedule(10, append, "a");
+        const Mif::TimerId b = wheel.schedule(10, append, "b");
+        const Mif::TimerId c = wheel.schedule(300, append, "c");
+
+        EXPECT_TRUE(wheel.cancel(b));
+        EXPECT_FALSE(wheel.cancel(b));
+        EXPECT_EQ(wheel.numPending(), 2);
+
+        EXPECT_EQ(wheel.advanceTo(10), 1);
+        EXPECT_EQ(g_fired, "a");
+        EXPECT_FALSE(wheel.cancel(a));
+
+        // a freed node reused by a new timer does not match the old id
+        const Mif::TimerId d = wheel.schedule(20, append, "d");
+        EXPECT_FALSE(wheel.cancel(a));
+        EXPECT_FALSE(wheel.cancel(b));
+
+        EXPECT_TRUE(wheel.cancel(c));
+        EXPECT_EQ(wheel.advanceTo(1000), 1);
+        EXPECT_EQ(g_fired, "ad");
+        EXPECT_FALSE(wheel.cancel(d));
+    }
+
+
+    TEST(TimerWheelTest, callbacksReschedule)
+    {
+        Mif::TimerWheel wheel;
+        uint32_t count = 0;
+        Mif::TimerId self = {};
+
+        // a periodic timer, and one that cancels a timer of the same batch
+        std::function<void()> periodic = [&]() {
+            count++;
+            self = wheel.scheduleAfter(5, periodic);
+        };
+
+        wheel.scheduleAfter(5, periodic);
+        Mif::TimerId victim = {};
+        wheel.schedule(50, [&wheel, &victim]() { EXPECT_TRUE(wheel.cancel(victim)); });
+        victim = wheel.schedule(50, []() { FAIL() << "cancelled timer fired"; });
+
+        EXPECT_EQ(wheel.advanceTo(49), 9);
+
+        const uint32_t chunks = wheel.numNodeChunks();
+        wheel.advanceTo(100000);
+
+        EXPECT_EQ(count, 20000);
+        EXPECT_EQ(wheel.numNodeChunks(), chunks);  // nodes are recycled
+        EXPECT_TRUE(wheel.cancel(self));
+    }
+
+} // namespace anonymouse